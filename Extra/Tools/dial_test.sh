@@ -0,0 +1,20 @@
+#!/bin/sh
+# Host test for the dial laser kill path (Pan_Tilt_laser/stu_dial.cpp).
+#
+#   Extra/Tools/dial_test.sh
+#
+# Builds dial_test/dial_test.cpp, which includes stu_dial.cpp, with a small
+# Arduino.h/util/atomic.h register shim, feeds synthetic ADC conversions to
+# the ISR and checks the kill count, the glitch release and the latch
+# rules. Exits non-zero on any failure.
+#
+# Needs g++.
+
+set -e
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+OUT=${TMPDIR:-/tmp}/dial_test
+
+g++ -std=gnu++11 -O2 -Wall -I"$HERE/dial_test" -I"$HERE/../../Pan_Tilt_laser" \
+  "$HERE/dial_test/dial_test.cpp" -o "$OUT"
+"$OUT" "$@"
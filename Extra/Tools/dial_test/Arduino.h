@@ -0,0 +1,28 @@
+// Host shim for stu_dial.cpp: the Arduino calls and ATmega328 registers it
+// touches, as plain variables the test can set and inspect.
+#pragma once
+#include <stdint.h>
+#include <stdlib.h>
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define INPUT 0
+#define _BV( b ) ( 1 << ( b ) )
+#define min( a, b ) ( ( a ) < ( b ) ? ( a ) : ( b ) )
+#define max( a, b ) ( ( a ) > ( b ) ? ( a ) : ( b ) )
+#define ISR( vect ) void vect( void )
+
+enum { REFS0 = 6, ADEN = 7, ADATE = 5, ADIE = 3, ADIF = 4, ADPS2 = 2, ADPS1 = 1, ADPS0 = 0, COM2A1 = 7 } ;
+
+extern volatile uint8_t PORTB, PORTC, PORTD, DDRB, DDRC, DDRD, PINB, PINC, PIND ;
+extern volatile uint8_t ADMUX, ADCSRA, ADCSRB, DIDR0, TCCR2A ;
+extern volatile uint16_t ADC ;
+extern int analogValue ;
+
+inline void pinMode( uint8_t, uint8_t ){}
+inline int analogRead( uint8_t ){ return analogValue ; }
+inline void delay( unsigned long ){}
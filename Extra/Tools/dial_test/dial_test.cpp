@@ -0,0 +1,116 @@
+/*
+    Host test for the dial laser kill path (Pan_Tilt_laser/stu_dial.cpp).
+
+    Drives StuDial::_isr() with synthetic ADC conversions, one call per
+    conversion, and getMode() for the main loop side. Checks:
+      - LASER_PIN goes low on exactly the DIAL_KILL_SAMPLES-th OFF
+        conversion in a row, and a non-OFF conversion restarts the count;
+      - the latch is not cleared by the filter while the ISR still sees
+        OFF readings (_killCount non-zero);
+      - a glitch (dial back in the current band) releases the latch
+        through _filter()/_release() without a mode change;
+      - a real move to OFF keeps the latch and a move back releases it
+        before getMode() reports the new mode.
+
+    This counts conversions (104 us each on the AVR); the time ADC_vect
+    waits behind other interrupts is not modelled. Build and run with
+    Extra/Tools/dial_test.sh.
+*/
+
+#include "stu_dial.cpp"
+#include <cstdio>
+
+volatile uint8_t PORTB, PORTC, PORTD, DDRB, DDRC, DDRD, PINB, PINC, PIND ;
+volatile uint8_t ADMUX, ADCSRA, ADCSRB, DIDR0, TCCR2A ;
+volatile uint16_t ADC ;
+int analogValue ;
+
+StuDial dial ;
+
+static const uint16_t
+  READ_OFF = 0 ,
+  READ_CONT = MAX_CONT_ADC ;
+
+static int failures = 0 ;
+
+static void check( bool ok, const char* what ){
+  std::printf( "%s  %s\n", ok ? "ok  " : "FAIL", what ) ;
+  failures += !ok ;
+}
+
+static bool laserOn( void ){
+  return FastPin< LASER_PIN >::port() & FastPin< LASER_PIN >::mask ;
+}
+
+// n conversions through the ADC vector; returns the conversion (1 based)
+// on which the laser pin went low, or 0.
+static uint16_t convert( uint16_t reading, uint16_t n ){
+  for( uint16_t i = 1; i <= n; i++ ){
+    bool was = laserOn() ;
+    ADC = reading ;
+    ADC_vect() ;
+    if( was && !laserOn() ){
+      return i ;
+    }
+  }
+  return 0 ;
+}
+
+// Conversions and main loop passes, one getMode() per filter sample.
+static runmode_e run( uint16_t reading, uint16_t samples ){
+  runmode_e mode = MODE_OFF ;
+
+  for( uint16_t i = 0; i < samples; i++ ){
+    convert( reading, DIAL_DECIMATE ) ;
+    mode = dial.getMode() ;
+  }
+  return mode ;
+}
+
+
+int main( void ){
+  analogValue = READ_CONT ;
+  dial.setPin( DIAL_PIN ) ;
+  dial.begin() ;
+  FastPin< LASER_PIN >::high() ;
+  check( dial.getMode() == MODE_CONTINUOUS && !StuDial::killed(), "boots in CONTINUOUS, not killed" ) ;
+
+  // Kill latency in conversions.
+  check( convert( READ_OFF, DIAL_KILL_SAMPLES - 1 ) == 0 && laserOn(), "laser still on before the last kill sample" ) ;
+  convert( READ_CONT, 1 ) ;
+  check( convert( READ_OFF, DIAL_KILL_SAMPLES - 1 ) == 0 && laserOn(), "a non-OFF conversion restarts the count" ) ;
+  run( READ_CONT, DIAL_MEDIAN_SAMPLES ) ;
+  uint16_t n = convert( READ_OFF, 100 ) ;
+  std::printf( "      laser cut on OFF conversion %u (worst case %u with the one in progress)\n", n, n + 1 ) ;
+  check( n == DIAL_KILL_SAMPLES && StuDial::killed(), "cut on the DIAL_KILL_SAMPLES-th OFF conversion" ) ;
+
+  // In-band samples already queued, ISR now seeing OFF: must stay killed.
+  FastPin< LASER_PIN >::high() ;
+  run( READ_CONT, DIAL_MEDIAN_SAMPLES ) ;
+  check( !StuDial::killed(), "glitch released through the filter" ) ;
+  FastPin< LASER_PIN >::high() ;
+  convert( READ_CONT, DIAL_DECIMATE - 1 ) ;
+  convert( READ_OFF, DIAL_KILL_SAMPLES ) ;   // queue now holds a CONT sample
+  check( StuDial::killed() && !laserOn(), "killed again" ) ;
+  dial.getMode() ;
+  check( StuDial::killed(), "filter does not release while the ISR sees OFF" ) ;
+
+  // Glitch: back in the CONTINUOUS band before the debounce elapses.
+  check( run( READ_CONT, DIAL_MEDIAN_SAMPLES ) == MODE_CONTINUOUS && !StuDial::killed(), "glitch: latch released, mode unchanged" ) ;
+
+  // Real move to OFF and back.
+  FastPin< LASER_PIN >::high() ;
+  check( run( READ_OFF, DIAL_DEBOUNCE + DIAL_MEDIAN_SAMPLES ) == MODE_OFF && StuDial::killed() && !laserOn(), "OFF: mode OFF, latch held" ) ;
+  bool heldUntilMode = true ;
+  runmode_e mode = MODE_OFF ;
+  for( uint16_t i = 0; i < 2 * ( DIAL_DEBOUNCE + DIAL_MEDIAN_SAMPLES ) && mode == MODE_OFF; i++ ){
+    mode = run( READ_CONT, 1 ) ;
+    if( mode == MODE_OFF && !StuDial::killed() ){
+      heldUntilMode = false ;
+    }
+  }
+  check( mode == MODE_CONTINUOUS && !StuDial::killed(), "back to CONTINUOUS releases the latch" ) ;
+  check( heldUntilMode, "latch held while the mode is still OFF" ) ;
+
+  return failures ? 1 : 0 ;
+}
@@ -0,0 +1,3 @@
+// Host shim: the test is single threaded, so the block just runs once.
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_BLOCK( type ) for( bool _once = true; _once; _once = false )
@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""Compile Markov model descriptions into PROGMEM alias tables.
+
+Reads a model file (see markov_models.txt) and writes the C header used by
+AliasMarkov (stuMarkov.h). Each transition row becomes an alias table with
+8-bit thresholds; a draw of one random byte r picks column (r*N)>>8 and
+compares (r*N)&0xFF against the threshold.
+
+usage: markov_gen.py MODELS [OUTPUT]   (OUTPUT defaults to stdout)
+"""
+
+import sys
+from fractions import Fraction
+
+
+class Model(object):
+
+    def __init__(self, name):
+        self.name = name
+        self.values = []
+        self.rows = []
+        self.counts = None
+
+    def add_trace(self, states):
+        n = len(self.values)
+        if self.counts is None:
+            self.counts = [[0] * n for _ in range(n)]
+        for a, b in zip(states, states[1:]):
+            self.counts[a][b] += 1
+
+    def probabilities(self):
+        rows = self.rows
+        if self.counts is not None:
+            if rows:
+                raise ValueError("%s: use either rows or traces" % self.name)
+            # add-one smoothing so unseen transitions stay possible
+            rows = [[c + 1 for c in r] for r in self.counts]
+        n = len(self.values)
+        if len(rows) != n or any(len(r) != n for r in rows):
+            raise ValueError("%s: need %d rows of %d weights" % (self.name, n, n))
+        out = []
+        for r in rows:
+            total = sum(r)
+            if total <= 0:
+                raise ValueError("%s: empty row" % self.name)
+            out.append([Fraction(w, total) for w in r])
+        return out
+
+
+def parse(path):
+    models = []
+    for lineno, line in enumerate(open(path), 1):
+        line = line.split('#', 1)[0].split()
+        if not line:
+            continue
+        key, args = line[0], line[1:]
+        if key == 'model':
+            models.append(Model(args[0]))
+            continue
+        if not models:
+            raise ValueError("%s:%d: '%s' before model" % (path, lineno, key))
+        m = models[-1]
+        nums = [int(a) for a in args]
+        if key == 'values':
+            if any(v < 0 or v > 255 for v in nums):
+                raise ValueError("%s:%d: values must fit in a byte" % (path, lineno))
+            m.values = nums
+        elif key == 'row':
+            m.rows.append(nums)
+        elif key == 'trace':
+            if any(s < 0 or s >= len(m.values) for s in nums):
+                raise ValueError("%s:%d: state out of range" % (path, lineno))
+            m.add_trace(nums)
+        else:
+            raise ValueError("%s:%d: unknown keyword '%s'" % (path, lineno, key))
+    return models
+
+
+def alias_row(p):
+    """Vose alias table with thresholds rounded to 1/256."""
+    n = len(p)
+    q = [x * n for x in p]
+    threshold = [256] * n
+    alias = list(range(n))
+    small = [i for i in range(n) if q[i] < 1]
+    large = [i for i in range(n) if q[i] >= 1]
+    while small and large:
+        s = small.pop()
+        l = large.pop()
+        threshold[s] = int(round(q[s] * 256))
+        alias[s] = l
+        q[l] = q[l] - (1 - q[s])
+        (small if q[l] < 1 else large).append(l)
+    # full columns alias to themselves so the threshold is irrelevant
+    return [(255, i) if threshold[i] >= 256 else (threshold[i], alias[i])
+            for i in range(n)]
+
+
+def realised(table_row):
+    """Exact distribution produced by the firmware's one-byte sampler."""
+    n = len(table_row)
+    hits = [0] * n
+    for r in range(256):
+        scaled = r * n
+        col, frac = scaled >> 8, scaled & 0xFF
+        threshold, alias = table_row[col]
+        hits[col if frac < threshold else alias] += 1
+    return [Fraction(h, 256) for h in hits]
+
+
+def emit(models, source):
+    out = []
+    out.append("/" + "*" * 74 + "/")
+    out.append("/*!")
+    out.append("    @file     stu_markov_models.h")
+    out.append("    @license  MIT (see license.txt)")
+    out.append("")
+    out.append("    GENERATED by Extra/Tools/markov_gen.py from %s." % source)
+    out.append("    Do not edit; change the model file and regenerate.")
+    out.append("")
+    out.append("    Transition models used by the sketch, as PROGMEM alias tables for")
+    out.append("    AliasMarkov. Each row is one current state; entries are")
+    out.append("    { threshold, alias } per column.")
+    out.append("")
+    out.append("    Include from the sketch only (tables are defined here).")
+    out.append("*/")
+    out.append("/" + "*" * 74 + "/")
+    out.append("#pragma once")
+    out.append("")
+    out.append('#include "stuMarkov.h"')
+    out.append("")
+    worst = 0
+    for m in models:
+        probs = m.probabilities()
+        n = len(m.values)
+        rows = [alias_row(p) for p in probs]
+        out.append("")
+        out.append("// %s: %d states, values %s" % (m.name, n, " ".join(str(v) for v in m.values)))
+        for i, (p, row) in enumerate(zip(probs, rows)):
+            got = realised(row)
+            worst = max([worst] + [abs(float(a - b)) for a, b in zip(p, got)])
+            out.append("//   %d -> %s" % (i, "  ".join("%5.1f%%" % (100 * float(x)) for x in p)))
+        out.append("static const aliasEntry_t %sTable[ %d * %d ] PROGMEM = {" % (m.name, n, n))
+        for i, row in enumerate(rows):
+            cells = ", ".join("{ %3d, %d }" % e for e in row)
+            out.append("  %s%s" % (cells, "," if i < n - 1 else ""))
+        out.append("};")
+        out.append("static const uint8_t %sValues[ %d ] PROGMEM = { %s };"
+                   % (m.name, n, ", ".join(str(v) for v in m.values)))
+        out.append("static const aliasModel_t %sModel PROGMEM = { %d, %sTable, %sValues };"
+                   % (m.name, n, m.name, m.name))
+    out.append("")
+    return "\n".join(out), worst
+
+
+def main(argv):
+    if len(argv) < 2:
+        sys.stderr.write(__doc__)
+        return 2
+    models = parse(argv[1])
+    text, worst = emit(models, argv[1].replace('\\', '/').split('/')[-1])
+    if len(argv) > 2:
+        open(argv[2], 'w').write(text)
+    else:
+        sys.stdout.write(text)
+    sys.stderr.write("%d models, worst probability error %.2f%%\n" % (len(models), 100 * worst))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""Build frames for the live parameter interface (stu_params.h).
+
+Writes the binary frame to stdout, e.g.
+  stty -F /dev/ttyACM0 9600 raw
+  python3 params_frame.py stage dirChangeProb=20 pauseMean=10 > /dev/ttyACM0
+  python3 params_frame.py commit > /dev/ttyACM0
+
+PROFILE builds: send "profile", then decode the reply frame, e.g.
+  python3 params_frame.py profile > /dev/ttyACM0
+  head -c 95 /dev/ttyACM0 | python3 params_frame.py decode-profile
+
+MEMORY_MONITOR builds: same with "memory" / "decode-memory" (19 bytes).
+
+WARM_BOOT builds: "recalibrate" clears the warm boot record, so the next
+power-up runs the full servo sweep.
+
+RECORDER builds: "record", "play" and "stop" drive the trajectory
+recorder; each reply decodes with "decode-record" (15 bytes), e.g.
+  python3 params_frame.py stop > /dev/ttyACM0
+  head -c 14 /dev/ttyACM0 | python3 params_frame.py decode-record stop
+
+Fields not given on the command line take the firmware defaults below
+(keep them in sync with StuParams::setDefaults()).
+"""
+
+import struct
+import sys
+
+SYNC = 0xA5
+COMMANDS = {'stage': 0x01, 'commit': 0x02, 'save': 0x03,
+            'load': 0x04, 'defaults': 0x05, 'get': 0x06, 'profile': 0x07,
+            'memory': 0x08, 'recalibrate': 0x09, 'record': 0x0A, 'play': 0x0B,
+            'stop': 0x0C}
+
+VERSION = 1
+FLAG_SPEED = 0x01
+FLAG_SHAKE = 0x02
+
+DEFAULTS = dict(flags=0, dirChangeProb=15, pauseMean=15, pauseVariance=6,
+                minX=30, maxX=110, minY=110, maxY=140)
+FIELDS = ['flags', 'dirChangeProb', 'pauseMean', 'pauseVariance',
+          'minX', 'maxX', 'minY', 'maxY']
+SPEED_ENTRIES = 3 * 3
+SHAKE_ENTRIES = 2 * 2
+
+
+def crc8_ccitt(data, crc=0):
+    """avr-libc _crc8_ccitt_update (poly 0x07)."""
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def frame(cmd, payload=b''):
+    body = bytes([cmd, len(payload)]) + payload
+    return bytes([SYNC]) + body + bytes([crc8_ccitt(body)])
+
+
+def block(values, speed=None, shake=None):
+    """speed/shake: lists of (threshold, alias) pairs, row-major.
+
+    A table is only sent when its flag is set; the firmware rejects a
+    flagged table with an all-zero row, so refuse to build one here."""
+    for table, flag, name in ((speed, FLAG_SPEED, 'speed'), (shake, FLAG_SHAKE, 'shake')):
+        if values['flags'] & flag and table is None:
+            raise SystemExit('flags select the %s table but none was given' % name)
+    out = struct.pack('B', VERSION)
+    out += bytes(values[f] for f in FIELDS)
+    for table, n in ((speed, SPEED_ENTRIES), (shake, SHAKE_ENTRIES)):
+        table = table or [(0, 0)] * n
+        out += b''.join(struct.pack('BB', t, a) for t, a in table)
+    return out
+
+
+# profileReport_t (stu_profile.h), little endian, no padding on AVR
+PROFILE_STAGES = ['params', 'motion', 'shake', 'scheduler', 'update', 'loop']
+
+
+def reply_body(data, command, flag):
+    """cmd | len | status | payload of the reply to command, checked."""
+    i = data.index(bytes([SYNC, 0x80 | COMMANDS[command]]))
+    length = data[i + 2]
+    body = data[i + 1:i + 3 + length]
+    if len(body) != length + 2 or crc8_ccitt(body) != data[i + 3 + length]:
+        raise SystemExit('bad frame')
+    if body[2] != 0:
+        raise SystemExit('status %d (firmware built without %s?)' % (body[2], flag))
+    return body
+
+
+def decode_profile(data):
+    """Print the stage table from a PARAM_CMD_PROFILE reply frame."""
+    body = reply_body(data, 'profile', 'PROFILE')
+    loops, elapsed = struct.unpack_from('<HI', body, 3)
+    print('loops %d in %d ms (%.1f Hz)' % (
+        loops, elapsed, loops * 1000.0 / elapsed if elapsed else 0))
+    print('%-10s %8s %10s %10s %10s' % ('stage', 'count', 'min us', 'avg us', 'max us'))
+    for n, name in enumerate(PROFILE_STAGES):
+        count, lo, hi, total = struct.unpack_from('<HIII', body, 9 + 14 * n)
+        avg = total // count if count else 0
+        print('%-10s %8d %10d %10d %10d' % (name, count, lo if count else 0, avg, hi))
+
+
+# memoryReport_t (stu_memory.h)
+MEMORY_FIELDS = ['ram', 'data', 'bss', 'heap', 'free now', 'free min', 'stack max']
+
+
+def decode_memory(data):
+    """Print a PARAM_CMD_MEMORY reply frame."""
+    body = reply_body(data, 'memory', 'MEMORY_MONITOR')
+    values = struct.unpack_from('<7H', body, 3)
+    for name, v in zip(MEMORY_FIELDS, values):
+        print('%-10s %5d bytes' % (name, v))
+
+
+# recordInfo_t (stu_record.h)
+RECORD_STATES = ['idle', 'recording', 'playing']
+
+
+def decode_record(data, command):
+    """Print a PARAM_CMD_RECORD/_PLAY/_STOP reply frame."""
+    body = reply_body(data, command, 'RECORDER')
+    state, start, length, raw, records = struct.unpack_from('<BHHHH', body, 3)
+    print('state     %s' % RECORD_STATES[state])
+    print('start     %d' % start)
+    print('records   %d' % records)
+    print('encoded   %d bytes' % length)
+    print('raw       %d bytes' % raw)
+    print('ratio     %.2f:1' % (raw / float(length) if length else 0))
+
+
+def main(argv):
+    if len(argv) == 2 and argv[1] == 'decode-profile':
+        decode_profile(sys.stdin.buffer.read())
+        return 0
+    if len(argv) == 2 and argv[1] == 'decode-memory':
+        decode_memory(sys.stdin.buffer.read())
+        return 0
+    if len(argv) == 3 and argv[1] == 'decode-record' and argv[2] in ('record', 'play', 'stop'):
+        decode_record(sys.stdin.buffer.read(), argv[2])
+        return 0
+    if len(argv) < 2 or argv[1] not in COMMANDS:
+        sys.stderr.write(__doc__)
+        return 2
+    payload = b''
+    if argv[1] == 'stage':
+        values = dict(DEFAULTS)
+        for arg in argv[2:]:
+            key, val = arg.split('=', 1)
+            if key not in values:
+                raise SystemExit('unknown field %s' % key)
+            values[key] = int(val, 0)
+        payload = block(values)
+    sys.stdout.buffer.write(frame(COMMANDS[argv[1]], payload))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,44 @@
+#!/bin/sh
+# Per-object RAM/flash breakdown of the Pan_Tilt_laser build.
+#
+#   Extra/Tools/ram_report.sh [build-dir]
+#
+# Builds the sketch for the Uno with arduino-cli into build-dir (default
+# /tmp/pan_tilt_build) unless an .elf is already there, then prints:
+#   - text/data/bss of every sketch, library and core object (avr-size)
+#   - the ATmega328P totals (avr-size -C)
+#   - the 25 largest RAM symbols (avr-nm)
+# RAM used by an object is data + bss; flash is text + data.
+#
+# Needs arduino-cli (with the arduino:avr core), avr-size and avr-nm on PATH.
+
+set -e
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+SKETCH="$HERE/../../Pan_Tilt_laser"
+BUILD=${1:-/tmp/pan_tilt_build}
+ELF="$BUILD/Pan_Tilt_laser.ino.elf"
+
+if [ ! -f "$ELF" ]; then
+  arduino-cli compile -b arduino:avr:uno --build-path "$BUILD" "$SKETCH"
+fi
+
+echo "== per object (bytes) =="
+find "$BUILD/sketch" "$BUILD/libraries" -name '*.o' 2>/dev/null | sort |
+  xargs avr-size -t |
+  awk 'NR == 1 { printf "%7s %7s %7s %7s  %s\n", "flash", "ram", "data", "bss", "object"; next }
+       { n = split( $6, p, "/" ); printf "%7d %7d %7d %7d  %s\n", $1 + $2, $2 + $3, $2, $3, p[ n ] }'
+
+if [ -f "$BUILD/core/core.a" ]; then
+  avr-size -t "$BUILD/core/core.a" | tail -1 |
+    awk '{ printf "%7d %7d %7d %7d  %s\n", $1 + $2, $2 + $3, $2, $3, "core.a" }'
+fi
+
+echo
+echo "== totals =="
+avr-size -C --mcu=atmega328p "$ELF"
+
+echo "== largest RAM symbols (size, type, name) =="
+avr-nm -S -t d --size-sort -C "$ELF" |
+  awk '$3 ~ /^[bBdD]$/ { size = $2 + 0; type = $3; $1 = $2 = $3 = ""; sub( /^ +/, "" ); printf "%6d %s %s\n", size, type, $0 }' |
+  tail -25
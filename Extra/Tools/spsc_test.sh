@@ -0,0 +1,21 @@
+#!/bin/sh
+# Host stress test for the lock-free SPSC ring (Pan_Tilt_laser/stu_spsc.h).
+#
+#   Extra/Tools/spsc_test.sh [items-per-capacity]
+#
+# Builds spsc_test/spsc_test.cpp against the sketch header with a small
+# Arduino.h/util/atomic.h shim, then runs producer and consumer on separate
+# threads for capacities 1, 4, 16 and 128 (default 4000000 items each).
+# Exits non-zero if any value is lost, duplicated or reordered, or if the
+# drop counter disagrees with the rejected pushes.
+#
+# Needs g++ with -pthread on an x86 host.
+
+set -e
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+OUT=${TMPDIR:-/tmp}/spsc_test
+
+g++ -std=gnu++11 -O2 -Wall -pthread -I"$HERE/spsc_test" -I"$HERE/../../Pan_Tilt_laser" \
+  "$HERE/spsc_test/spsc_test.cpp" -o "$OUT"
+"$OUT" "$@"
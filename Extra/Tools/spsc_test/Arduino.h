@@ -0,0 +1,2 @@
+// Host shim for stu_spsc.h: only the fixed-width integer types are used.
+#include <stdint.h>
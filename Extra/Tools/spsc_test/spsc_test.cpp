@@ -0,0 +1,101 @@
+/*
+    Host stress test for StuSpsc (Pan_Tilt_laser/stu_spsc.h).
+
+    A producer thread (standing in for the ISR) pushes a counting sequence
+    and retries every rejected push; a consumer thread (the main loop) pops
+    and polls takeDropped(). Checks that every value arrives exactly once
+    and in order, that the queue never reports more than N items, and that
+    takeDropped() adds up to the number of rejected pushes.
+
+    The ring relies on single-byte index loads/stores and compiler
+    barriers, so this is only meaningful on a host with in-order stores
+    and loads (x86). Build and run with Extra/Tools/spsc_test.sh.
+*/
+
+#include "stu_spsc.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+std::mutex isrLock ;
+
+template< uint8_t N >
+static bool stress( uint32_t count ){
+  StuSpsc< uint16_t, N > q ;
+  uint32_t rejected = 0 ;
+  uint32_t dropped = 0 ;
+  uint32_t received = 0 ;
+  std::atomic< bool > failed( false ) ;
+
+  std::thread producer( [ & ](){
+    for( uint32_t n = 0; n < count && !failed; ){
+      bool ok ;
+
+      {
+        std::lock_guard< std::mutex > isr( isrLock ) ;
+        ok = q.push( (uint16_t)n ) ;
+      }
+      if( ok ){
+        n++ ;
+      }
+      else{
+        // Wait for room so at most one push fails per pop and the 8 bit
+        // drop counter can't saturate between two takeDropped() calls.
+        rejected++ ;
+        while( q.full() && !failed ){
+          std::this_thread::yield() ;
+        }
+      }
+    }
+  } ) ;
+
+  std::thread consumer( [ & ](){
+    while( received < count && !failed ){
+      uint16_t v ;
+
+      if( q.size() > N ){
+        std::printf( "N=%u: size %u over capacity\n", N, q.size() ) ;
+        failed = true ;
+      }
+      if( q.pop( v ) ){
+        if( v != (uint16_t)received ){
+          std::printf( "N=%u: got %u, expected %u\n", N, v, (uint16_t)received ) ;
+          failed = true ;
+        }
+        received++ ;
+      }
+      else{
+        std::this_thread::yield() ;
+      }
+      dropped += q.takeDropped() ;
+    }
+  } ) ;
+
+  producer.join() ;
+  consumer.join() ;
+  dropped += q.takeDropped() ;
+
+  if( !failed && !q.empty() ){
+    std::printf( "N=%u: %u items left after the last value\n", N, q.size() ) ;
+    failed = true ;
+  }
+  if( !failed && dropped != rejected ){
+    std::printf( "N=%u: takeDropped() total %u, rejected pushes %u\n", N, dropped, rejected ) ;
+    failed = true ;
+  }
+  std::printf( "N=%-3u %s  %u items, %u rejected pushes\n", N, failed ? "FAIL" : "ok  ", received, rejected ) ;
+  return !failed ;
+}
+
+int main( int argc, char** argv ){
+  uint32_t count = argc > 1 ? std::strtoul( argv[ 1 ], NULL, 0 ) : 4000000UL ;
+  bool ok = true ;
+
+  ok &= stress< 1 >( count ) ;
+  ok &= stress< 4 >( count ) ;
+  ok &= stress< 16 >( count ) ;
+  ok &= stress< 128 >( count ) ;
+
+  return ok ? 0 : 1 ;
+}
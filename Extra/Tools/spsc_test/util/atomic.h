@@ -0,0 +1,7 @@
+// Host shim for stu_spsc.h. On the AVR, ATOMIC_BLOCK keeps the producer ISR
+// out; here it takes isrLock, which the test's producer thread holds around
+// each push() the way an ISR runs to completion.
+#include <mutex>
+extern std::mutex isrLock ;
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_BLOCK( type ) for( std::unique_lock< std::mutex > _isrGuard( isrLock ); _isrGuard.owns_lock(); _isrGuard.unlock() )
@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+"""Decode the binary telemetry stream (stu_telemetry.h).
+
+Reads the raw serial stream from a file or stdin and prints one line per
+frame, e.g.
+  stty -F /dev/ttyACM0 9600 raw
+  python3 telemetry_decode.py /dev/ttyACM0
+
+Frame: COBS( id | dt | varint fields... | crc8 ) 0x00
+"""
+
+import sys
+
+# id: (name, field names); keep in sync with telemetry_e
+MESSAGES = {
+    1: ('BOOT', ['seed']),
+    2: ('STATE', ['state', 'mode']),
+    3: ('POSITION', ['~x', '~y']),        # ~ marks zig-zag signed fields
+    4: ('MARKOV', ['chain', 'value']),
+    5: ('PAUSE', ['ms', 'laser']),
+    6: ('NEXT_PAUSE', ['ms']),
+    7: ('DROPPED', ['frames']),
+}
+STATES = ['OFF', 'RUN', 'REST']
+MODES = ['OFF', 'CONTINUOUS', 'INTERMITTENT', 'SLEEP']
+CHAINS = ['speed', 'shake', 'pause']
+
+
+def crc8_ccitt(data, crc=0):
+    """avr-libc _crc8_ccitt_update (poly 0x07)."""
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data) + 1:
+            raise ValueError('bad COBS block')
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def varints(data):
+    value = shift = 0
+    for b in data:
+        value |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            yield value
+            value = shift = 0
+    if shift:
+        raise ValueError('truncated varint')
+
+
+def unzigzag(v):
+    return (v >> 1) ^ -(v & 1)
+
+
+def decode(frame):
+    """Returns (name, dt_ms, {field: value}) or raises ValueError."""
+    raw = cobs_decode(frame)
+    if len(raw) < 3 or crc8_ccitt(raw[:-1]) != raw[-1]:
+        raise ValueError('bad crc')
+    name, fields = MESSAGES.get(raw[0], ('ID%d' % raw[0], []))
+    values = list(varints(raw[1:-1]))
+    dt, values = values[0], values[1:]
+    out = {}
+    for field, v in zip(fields, values):
+        if field.startswith('~'):
+            field, v = field[1:], unzigzag(v)
+        out[field] = v
+    return name, dt, out
+
+
+def describe(name, fields):
+    if name == 'STATE':
+        fields['state'] = STATES[fields['state']] if fields['state'] < len(STATES) else fields['state']
+        fields['mode'] = MODES[fields['mode']] if fields['mode'] < len(MODES) else fields['mode']
+    elif name == 'MARKOV':
+        fields['chain'] = CHAINS[fields['chain']] if fields['chain'] < len(CHAINS) else fields['chain']
+    return ' '.join('%s=%s' % kv for kv in fields.items())
+
+
+def main(argv):
+    stream = open(argv[1], 'rb') if len(argv) > 1 else sys.stdin.buffer
+    t = 0
+    frames = nbytes = bad = 0
+    buf = bytearray()
+    while True:
+        chunk = stream.read(1)
+        if not chunk:
+            break
+        nbytes += 1
+        if chunk[0]:
+            buf += chunk
+            continue
+        if not buf:
+            continue
+        try:
+            name, dt, fields = decode(bytes(buf))
+            t += dt
+            frames += 1
+            print('%10.3f %-10s %s' % (t / 1000.0, name, describe(name, fields)))
+            sys.stdout.flush()
+        except ValueError as e:
+            bad += 1
+            sys.stderr.write('skipped frame: %s\n' % e)
+        buf = bytearray()
+    if frames:
+        sys.stderr.write('%d frames, %d bytes (%.1f bytes/frame), %d bad\n'
+                         % (frames, nbytes, nbytes / float(frames), bad))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -28,6 +28,21 @@ v1.8.0 - Switched to a state-machine model.
 v1.9.0 - Final Version
 v1.9.1 - Tweaked minimum Y servo value
 v1.9.2 - Fixed bug where pauseTask was still enabled when off.
+v1.10.0 - Added deterministic lure patterns (MOTION_PATTERN).
+v1.11.0 - Added spline trajectories between sparse waypoints (MOTION_SPLINE).
+v1.11.1 - Axis limits are compile-time; random walk moved to stu_walk.h.
+v1.12.0 - Speed, shake and pause chains use PROGMEM alias tables.
+v1.12.1 - Switched hot-path random numbers to the seedable StuRandom.
+v1.12.2 - Integer Gaussian pause scheduling (no floating point).
+v1.12.3 - Direction changes use per-axis precomputed threshold tables.
+v1.13.0 - Live motion parameter tuning over serial (PARAM_SERIAL).
+v1.13.1 - Dial is sampled by interrupt; seed taken before the dial owns the ADC.
+v1.14.0 - Optional per-stage loop() profiler (PROFILE).
+v1.15.0 - Binary telemetry stream (TELEMETRY) replaces per-loop state prints.
+v1.15.1 - Buffered logging with per-module levels replaces SERIAL_DEBUG prints.
+v1.16.0 - Warm boot from an EEPROM record skips the calibration sweep (WARM_BOOT).
+v1.17.0 - Trajectory record and replay from EEPROM (RECORDER).
+v1.18.0 - Extra pan/tilt mounts (PANTILT_TURRETS) that mirror turret 0's laser and pauses.
 */
 /**************************************************************************/
 
@@ -36,48 +51,102 @@ v1.9.2 - Fixed bug where pauseTask was still enabled when off.
 #include <Time.h>
 #include <Servo.h>
 #include "stuMarkov.h"
+#include "stu_markov_models.h"
 #include "stuLaser.h"
 #include "stu_scheduler.h"
 #include "stu_gauss.h"
-#include <Gaussian.h>
 #include "stu_dial.h"
+#include "stu_pattern.h"
+#include "stu_spline.h"
+#include "stu_walk.h"
+#include "stu_random.h"
+#include "stu_params.h"
+#include "stu_profile.h"
+#include "stu_telemetry.h"
+#include "stu_log.h"
+#include "stu_boot.h"
+#include "stu_record.h"
 
 
 #define MIN_LOOP_TIME 0
 
 
-int markovShakeState = 1;
-int changeVal;
+// Per-turret Markov state, one array per field like the axis bank. The
+// speed and shake models are shared; each turret keeps its own position in
+// the chains.
+typedef struct turretMarkov_t{
+  uint8_t
+    speedState[ PANTILT_TURRETS ],
+    shakeState[ PANTILT_TURRETS ],
+    changeVal[ PANTILT_TURRETS ],   // degrees per step
+    shake[ PANTILT_TURRETS ];       // 2 == shake this turret
+}turretMarkov_t;
 
-LinkedMarkov lmSpeed;
-LinkedMarkov lmShake;
-LinkedMarkov lmPause;
+turretMarkov_t turretMarkov;
 
+AliasMarkov lmSpeed( &speedModel );
+AliasMarkov lmShake( &shakeModel );
+AliasMarkov lmPause( &pauseModel, 1 );
+
+// Turret 0 (panTilt) leads: its state callbacks drive the pause scheduling
+// and the pattern, spline and replay generators follow its speed. Extra
+// turrets share its laser and servo power pins, so they follow its laser
+// state and pauses. Add one PanTilt per extra mount and list it here.
 PanTilt panTilt( SERVO_X_PIN, SERVO_Y_PIN );
 
+PanTilt* const turrets[] = {
+  &panTilt
+};
+static_assert( sizeof( turrets ) / sizeof( turrets[ 0 ] ) == PANTILT_TURRETS, "list one PanTilt in turrets[] per PANTILT_TURRETS" );
+
+#if MOTION_TYPE == MOTION_PATTERN
+StuPattern pattern;
+#elif MOTION_TYPE == MOTION_SPLINE
+StuSpline spline;
+#endif
+
 
 Task pauseTask(&pauseCB);
 Task updateMarkovTask(&updateMarkov, 750, 1);
 
 void updateMarkov(){
-  changeVal = lmSpeed.getNextValue();
-  markovShakeState = lmShake.getNextValue();
+  turretMarkov_t& m = turretMarkov;
+
+  for(uint8_t t = 0; t < PANTILT_TURRETS; t++){
+    lmSpeed.setState(m.speedState[t]);
+    m.changeVal[t] = lmSpeed.getNextValue();
+    m.speedState[t] = lmSpeed.getState();
+
+    lmShake.setState(m.shakeState[t]);
+    m.shake[t] = lmShake.getNextValue();
+    m.shakeState[t] = lmShake.getState();
+  }
+  TLM_MARKOV(TLM_CHAIN_SPEED, m.changeVal[0]);
+  TLM_MARKOV(TLM_CHAIN_SHAKE, m.shake[0]);
   updateMarkovTask.enable();
 
 }
 
+// New parameter block went live (control-period boundary)
+void paramsCB(){
+  const motionParams_t& p = params.get();
+
+  buildDirectionTable<panTiltPosX_t>(p.dirChangeProb);
+  buildDirectionTable<panTiltPosY_t>(p.dirChangeProb);
+
+  lmSpeed.setTable( (p.flags & PARAM_FLAG_SPEED) && pgm_read_byte(&speedModel.states) == PARAM_SPEED_STATES ? p.speed : NULL );
+  lmShake.setTable( (p.flags & PARAM_FLAG_SHAKE) && pgm_read_byte(&shakeModel.states) == PARAM_SHAKE_STATES ? p.shake : NULL );
+
+}
+
 //halt laser at certain spot for a few moments at this time
-void setNextPauseTime(unsigned long avg_sec_to_pause=15, double variance=6){
+void setNextPauseTime(){
+  const motionParams_t& p = params.get();
 
-  unsigned long temp = gauss.gRandom(avg_sec_to_pause, variance)*1000;
+  unsigned long temp = gauss.gRandom(p.pauseMean, p.pauseVariance)*1000;
 
-  #ifdef SERIAL_DEBUG
-  #ifdef TIME_DEBUG
-  MY_SERIAL.print(F("Next pause in "));
-  MY_SERIAL.print(temp/1000);
-  MY_SERIAL.println(F(" seconds.\n"));
-  #endif
-  #endif
+  LOGV(TIME, INFO, "Next pause in (s): ", temp/1000);
+  TLM_NEXT_PAUSE(temp);
 
   pauseTask.setInterval(temp);
   pauseTask.enable();
@@ -92,9 +161,7 @@ void offCB(){
 
 void runCB(){
 
-  #ifdef SERIAL_DEBUG
-  MY_SERIAL.println(F("RUN CALLBACK"));
-  #endif
+  LOG(MAIN, INFO, "RUN CALLBACK");
 
   setNextPauseTime();
 
@@ -102,9 +169,7 @@ void runCB(){
 
 void restCB(){
 
-  #ifdef SERIAL_DEBUG
-  MY_SERIAL.println(F("REST CALLBACK"));
-  #endif
+  LOG(MAIN, INFO, "REST CALLBACK");
 
   return;
 }
@@ -114,65 +179,90 @@ void pauseCB(){
 
   pauseTask.disable();
 
-  #ifdef SERIAL_DEBUG
-  MY_SERIAL.println(F("PAUSE CALLBACK"));
-  #endif
-
-  panTilt.pause( markovPause(), !!(random()%4) );
+  LOG(MAIN, INFO, "PAUSE CALLBACK");
 
-  setNextPauseTime();
+  if( REC_IS_PLAYING() ){ // the recording carries its own pauses
+    setNextPauseTime();
+    return;
+  }
 
-}
+  int pauseTime = markovPause();
+  bool laserOn = !!(rng.nextByte() & 3);
 
-void panTiltCB(){
+  TLM_PAUSE(pauseTime, laserOn);
+  REC_LOG_PAUSE(pauseTime, laserOn);
+  panTilt.pause( pauseTime, laserOn );
 
-  #ifdef SERIAL_DEBUG
-  MY_SERIAL.println(F("Main Sketch PanTilt Callback!!!! "));
+  #if MOTION_TYPE == MOTION_PATTERN
+  pattern.setPattern( (pattern_e)rng.below( PATTERN_COUNT ) );
   #endif
 
+  setNextPauseTime();
+
+}
+
+// Same target for every turret (pattern, spline and replay)
+void setAllAngles(int x, int y){
+  for(uint8_t t = 0; t < PANTILT_TURRETS; t++){
+    axes.angleX[t] = x;
+    axes.angleY[t] = y;
+  }
+}
 
-  panTilt.callback();
+// Playback (RECORDER) stands in for the motion generator
+bool replayStep(){
+  #ifdef RECORDER
+  if( !recorder.playing() ){
+    return false;
+  }
 
+  if( recorder.poll() == REC_EVENT_PAUSE ){
+    panTilt.pause( recorder.getPauseTime(), recorder.getPauseLaser() );
+  }
+  setAllAngles(constrain(recorder.getX(), params.get().minX, params.get().maxX),
+               constrain(recorder.getY(), params.get().minY, params.get().maxY));
+  return true;
+  #else
+  return false;
+  #endif
 }
 
 void setup() {
 
 
-  #ifdef SERIAL_DEBUG
+  #if defined(SERIAL_DEBUG) || defined(PARAM_SERIAL) || defined(TELEMETRY)
   MY_SERIAL.begin(BAUD_RATE);
-  MY_SERIAL.println(F("setup starting..."));
   #endif
 
-  panTilt.begin();
+  LOG(MAIN, INFO, "setup starting...");
+
+  rng.seed(analogRead(5)); // before panTilt.begin(): the dial then owns the ADC
+  bootLoad();              // warm boot record, also stirs in the saved RNG state
+  TLM_BOOT(rng.getState());
+
+  for(uint8_t t = 0; t < PANTILT_TURRETS; t++){
+    turrets[t]->begin(); // in id order; turret 0 also sets up the dial and LEDs
+  }
   panTilt.setStateCallback(STATE_OFF, &offCB);
   panTilt.setStateCallback(STATE_RUN, &runCB);
   panTilt.setStateCallback(STATE_REST, &restCB);
 
-  Task* taskPtr = panTilt.getTaskPtr();
 
-  taskPtr->changeCallback(panTiltCB);
-
-
-  //        addLinkToBack(speed, previous_state_probability, next_state_probability)
-  lmSpeed.addLinkToBack( 1,  5, 35 ); // Slow
-  //                           ^  ||
-  //                           |  \/
-  lmSpeed.addLinkToBack( 2, 25, 35 ); // Med
-  //                           ^  ||
-  //                           |  \/
-  lmSpeed.addLinkToBack( 3, 35, 25 ); // Fast
-  //                           ^  ||
-  //                           |  \/
-  //                          | Slow |
+  params.setApplyCallback(&paramsCB);
+  params.begin(); // loads EEPROM block (or defaults) and builds the walk tables
+  REC_BEGIN();
 
+  #if defined(SERIAL_DEBUG) && defined(RANDOM_BENCHMARK)
+  randomBenchmark();
+  #endif
 
-  //        addLinkToBack(state, previous_state_probability, next_state_probability)
-  lmShake.addLinkToBack( 1,  0, 2 ); // No shake
-  //                           ^  ||
-  //                           |  \/
-  lmShake.addLinkToBack( 2, 40, 0 ); // Shake
+  #if defined(SERIAL_DEBUG) && defined(GAUSS_BENCHMARK)
+  gaussBenchmark();
+  #endif
 
-  randomSeed(analogRead(5));
+  #if MOTION_TYPE == MOTION_SPLINE
+  spline.reset<panTiltPosX_t, panTiltPosY_t>();
+  #endif
 
 
   scheduler.addEvent(&pauseTask);
@@ -180,9 +270,8 @@ void setup() {
 
 
 
-  #ifdef SERIAL_DEBUG
-  MY_SERIAL.println(F("setup complete"));
-  #endif
+  LOG(MAIN, INFO, "setup complete");
+  LOG_FLUSH();
 
   setNextPauseTime();
 
@@ -190,12 +279,15 @@ void setup() {
 
 
 void loop(){
-
-
-  #ifdef SERIAL_DEBUG
-  MY_SERIAL.println(panTilt.getState());
-  #endif
-
+  PROFILE_SCOPE(PROF_LOOP);
+  PROFILE_LOOP();
+
+  // control-period boundary: take new parameters only here
+  {
+    PROFILE_SCOPE(PROF_PARAMS);
+    params.poll();
+    params.apply();
+  }
 
   if( panTilt.getState() == STATE_RUN ){
     if(!pauseTask.enabled()){
@@ -203,12 +295,32 @@ void loop(){
 
     }
 
-    panTilt.posX.angle = getDeltaPosition(&panTilt.posX, changeVal, DIRECTION_CHANGE_PROBABILITY) + panTilt.posX.angle;
-    panTilt.posY.angle = getDeltaPosition(&panTilt.posY, changeVal, DIRECTION_CHANGE_PROBABILITY) + panTilt.posY.angle;
+    {
+      PROFILE_SCOPE(PROF_MOTION);
+      if( !replayStep() ){
+        #if MOTION_TYPE == MOTION_PATTERN
+        pattern.step(turretMarkov.changeVal[0]);
+        setAllAngles(constrain(pattern.getX<panTiltPosX_t>(), params.get().minX, params.get().maxX),
+                     constrain(pattern.getY<panTiltPosY_t>(), params.get().minY, params.get().maxY));
+        #elif MOTION_TYPE == MOTION_SPLINE
+        spline.step<panTiltPosX_t, panTiltPosY_t>(turretMarkov.changeVal[0]);
+        setAllAngles(constrain(spline.getX(), params.get().minX, params.get().maxX),
+                     constrain(spline.getY(), params.get().minY, params.get().maxY));
+        #else
+        walkAxes<panTiltPosX_t>(axes.angleX, axes.dirX, turretMarkov.changeVal, PANTILT_TURRETS, params.get().minX, params.get().maxX);
+        walkAxes<panTiltPosY_t>(axes.angleY, axes.dirY, turretMarkov.changeVal, PANTILT_TURRETS, params.get().minY, params.get().maxY);
+        #endif
+        REC_SAMPLE(axes.angleX[0], axes.angleY[0]);
+      }
+      TLM_POSITION(axes.angleX[0], axes.angleY[0]);
+    }
 
 
-    if(markovShakeState == 2){
-      panTilt.shake();
+    for(uint8_t t = 0; t < PANTILT_TURRETS; t++){
+      if(turretMarkov.shake[t] == 2){
+        PROFILE_SCOPE(PROF_SHAKE);
+        turrets[t]->shake();
+      }
     }
   }
 
@@ -216,55 +328,36 @@ void loop(){
 
 
   }
-  scheduler.run();
-  panTilt.update();
-  delay(5);
-
-}
-
-
-int getMarkovDirection(panTiltPos_t *pt, int changeProb){
-
-  int prob = changeProb;
-
-  if(pt->dir == 0){
-    pt->dir = 1;
-  }
-
-  if((pt->dir == 1 && pt->angle >= pt->midAngle) || (pt->dir == -1 && pt->angle <= pt->midAngle)){
-    prob += abs(pt->midAngle - pt->angle) * max(pt->probOffset, 1);
-
+  {
+    PROFILE_SCOPE(PROF_SCHEDULER);
+    scheduler.run();
   }
-
-  if(random(1001) <= prob << 1 || (pt->angle >= pt->maxAngle && pt->dir == 1) || pt->angle <= pt->minAngle && pt->dir == -1){
-    pt->dir *= -1;
+  {
+    PROFILE_SCOPE(PROF_UPDATE);
+    for(uint8_t t = 0; t < PANTILT_TURRETS; t++){
+      turrets[t]->update();
+    }
   }
-  return pt->dir;
-}
+  LOG_IDLE(5); // idle time: print buffered log entries
 
 
-int getDeltaPosition(panTiltPos_t *pt, int funcChangeVal, int changeProb){
+}
 
-  int tempVal = getMarkovDirection(pt, changeProb);
 
-  tempVal *= funcChangeVal;
+int markovPause(){
 
-  return tempVal;
+  uint8_t pauseState = lmPause.getNextValue();
 
-}
+  TLM_MARKOV(TLM_CHAIN_PAUSE, pauseState);
+  switch(pauseState){
+    case 2:
+      return rng.range(1500, 2000);
 
+    case 1:
+      return rng.range(1000, 1500);
 
-int markovPause(){
-  int val = random(101);
-
-  if(val < 25){
-    return random(1500, 2000);
-  }
-  else if(val < 90){
-    return random(1000, 1500);
-  }
-  else{
-    return random(500, 750);
+    default:
+      return rng.range(500, 750);
   }
 
 }
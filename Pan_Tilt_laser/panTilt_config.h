@@ -7,14 +7,54 @@
 
 
 //#define SERIAL_DEBUG
+//#define PARAM_SERIAL // binary live-tuning interface (stu_params.h)
+//#define TELEMETRY    // COBS/varint binary event stream (stu_telemetry.h), needs MY_SERIAL to itself
+//#define PROFILE      // loop() stage timing, read with PARAM_CMD_PROFILE (stu_profile.h)
+//#define MEMORY_MONITOR // stack painting and free RAM, read with PARAM_CMD_MEMORY (stu_memory.h)
+#define WARM_BOOT      // skip the boot sweep when calibration and mode are unchanged (stu_boot.h)
+//#define RECORDER       // trajectory record/replay in EEPROM, PARAM_CMD_RECORD/_PLAY/_STOP (stu_record.h)
+
+// Log level per module with SERIAL_DEBUG (stu_log.h): LOG_NONE, LOG_ERROR,
+// LOG_WARN, LOG_INFO or LOG_DEBUG
+#define LOG_LEVEL_MAIN    LOG_INFO  // sketch callbacks
+#define LOG_LEVEL_TIME    LOG_NONE  // pause scheduling
+#define LOG_LEVEL_PANTILT LOG_INFO  // mode and state changes
+#define LOG_LEVEL_SCHED   LOG_WARN  // scheduler events and timers
+#define LOG_LEVEL_DIAL    LOG_DEBUG // dial readings
+#define LOG_LEVEL_DISPLAY LOG_NONE  // LED patterns
+#define LOG_LEVEL_GAUSS   LOG_NONE  // gaussian draws
+#define LOG_LEVEL_REC     LOG_INFO  // trajectory recorder
+
+#if ( defined(PROFILE) || defined(MEMORY_MONITOR) || defined(RECORDER) ) && !defined(PARAM_SERIAL)
+  #define PARAM_SERIAL // reports and commands go over the parameter interface
+#endif
+
+#if defined(TELEMETRY) && ( defined(PARAM_SERIAL) || defined(SERIAL_DEBUG) )
+  #error "TELEMETRY frames share MY_SERIAL with no other framing: disable SERIAL_DEBUG and PARAM_SERIAL (PROFILE, MEMORY_MONITOR, RECORDER)"
+#endif
 
 
-#ifdef SERIAL_DEBUG
+#if defined(SERIAL_DEBUG) || defined(PARAM_SERIAL) || defined(TELEMETRY)
   #define BAUD_RATE 9600
 #endif
 
 #define DIRECTION_CHANGE_PROBABILITY 15
 
+// Motion generator driving the laser
+#define MOTION_RANDOM_WALK 0 // Markov random walk
+#define MOTION_PATTERN     1 // Deterministic lure patterns (stu_pattern.h)
+#define MOTION_SPLINE      2 // Smooth splines through random waypoints (stu_spline.h)
+
+#define MOTION_TYPE MOTION_RANDOM_WALK
+
+
+// Pan/tilt mounts driven by this controller. Each is a PanTilt with its own
+// servo signal pins and random walk. The dial, LEDs, servo power and laser
+// pins below are shared, and only turret 0 gets state callbacks and
+// pause(), so extra mounts move independently but mirror turret 0's laser
+// and pauses. Each also takes a scheduler event, so at most
+// MAX_EVENTS - 2 (stu_scheduler.h checks this).
+#define PANTILT_TURRETS 1
 
 // Servo pins
 #define X_PWR_PIN   A3
@@ -28,11 +68,13 @@
 #define INT_PIN   3 // Intermittent LED pin
 
 #define LASER_PIN 9
+//#define LASER_PWM        // Timer2 brightness and effects (stu_laser_fx.h)
+#define LASER_BRIGHTNESS 255 // perceptual level when on, 0-255
 
 #define DIAL_PIN A2
 
 
-#ifdef SERIAL_DEBUG
+#if defined(SERIAL_DEBUG) || defined(PARAM_SERIAL) || defined(TELEMETRY)
 
 #define MY_SERIAL Serial
 
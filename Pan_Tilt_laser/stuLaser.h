@@ -12,6 +12,10 @@
 
     @section  HISTORY
     v0.0.1 - First release
+    v0.1.0 - Pin is a template parameter (FastPin), header only.
+    v0.2.0 - LASER_PWM routes through the Timer2 brightness/effect driver
+             (stu_laser_fx.h); fade() for soft pauses.
+    v0.2.1 - fire() is ignored while the dial kill latch is set.
 
 */
 /**************************************************************************/
@@ -19,20 +23,51 @@
 #pragma once
 
 #include "Arduino.h"
+#include "stu_fastpin.h"
+#include "panTilt_config.h"
+#include "stu_dial.h"
+#include <util/atomic.h>
 
+#ifdef LASER_PWM
+  #include "stu_laser_fx.h"
+#endif
+
+template< uint8_t PIN >
 class StuLaser {
 
 public:
 
-  StuLaser( uint8_t laserPin );
+#ifdef LASER_PWM
+    static_assert( PIN == LASER_PIN, "PWM laser driver is bound to LASER_PIN" ) ;
+
+    void begin( void ){
+      laserFx.begin() ;
+    }
+
+    void fire( boolean state ){
+      laserFx.fire( state ) ;
+    }
 
-    void
-      begin( void ) ,
-      fire( boolean state ) ;
+    void fade( boolean in ){
+      laserFx.play( in ? LASER_FX_FADE_IN : LASER_FX_FADE_OUT ) ;
+    }
+#else
+    void begin( void ){
+      FastPin< PIN >::low() ;
+      FastPin< PIN >::output() ;
+    }
 
-private:
+    // Checked with interrupts off so a kill from the dial ISR can't be
+    // overwritten between the check and the write.
+    void fire( boolean state ){
+      ATOMIC_BLOCK( ATOMIC_RESTORESTATE ){
+        FastPin< PIN >::write( state && !StuDial::killed() ) ;
+      }
+    }
 
-    uint8_t
-      _pin ;
+    void fade( boolean in ){
+      fire( in ) ;
+    }
+#endif
 
 };
@@ -10,6 +10,11 @@
 
     @section  HISTORY
     v0.0.1 - First release
+    v0.1.0 - Added AliasMarkov: dense N-state chains sampled from PROGMEM
+             alias tables.
+    v0.1.1 - LinkedMarkov links are 5 bytes: byte indices instead of
+             pointers, byte values and probabilities.
+    v0.2.0 - Removed LinkedMarkov; every chain is an AliasMarkov.
 
 */
 /**************************************************************************/
@@ -18,64 +23,57 @@
 
 
 
-  LinkedMarkov::LinkedMarkov(){
-    _itr = 0 ;
-    _head = &_mValue[ _itr ] ;
-    _current = _head ;
-    _tail = _head ;
-    _current->previous.markovLink = _head ;
-    _current->next.markovLink = _head ;
+  AliasMarkov::AliasMarkov( const aliasModel_t* model, uint8_t initialState ):_model( model ), _ramTable( NULL ), _state( initialState ){
 
   }
 
 
-  void LinkedMarkov::addLinkToBack( unsigned int value, unsigned int prevVal, unsigned int nextVal ) {
-
-    assert( prevVal + nextVal <= 100 );       // make sure that change probabilites are less than one hundred
-    assert( _itr < LINKED_LIST_SIZE ) ;       // prevent overflow.
-
-    markovLink_t* newLinkPtr;
-
-    newLinkPtr = &_mValue[ _itr++ ] ;         // get pointer to current spot in linked list and iterate pointer for next time.
-
-    newLinkPtr->value = value ;
-
-    newLinkPtr->next.markovLink = _head ;     // new last element (tail), so set next to head.
-    newLinkPtr->next.probability = nextVal ;
+  void AliasMarkov::setState( uint8_t state ){
+    if( state < pgm_read_byte( &_model->states ) ){
+      _state = state ;
+    }
 
-    newLinkPtr->previous.markovLink = _tail ; // set new link (new tail) previous-link to old tail
-    newLinkPtr->previous.probability = prevVal ;
+  }
 
-    _tail->next.markovLink = newLinkPtr ;     // set old tail next-link to new link (new tail)
-    _tail = newLinkPtr ;                      // set tail pointer to new tail (new link)
+  // Live-tuned tables (stu_params.h) are used from RAM; the caller keeps
+  // the table alive and sized states x states.
+  void AliasMarkov::setTable( const aliasEntry_t* ramTable ){
+    _ramTable = ramTable ;
 
   }
 
-  unsigned int LinkedMarkov::getNextValue( void ) {
-    uint8_t randVal = random( 101 ) ;
-    assert( randVal >= 0 ) ;
-    assert( randVal <= 100 ) ;
+  // One random byte picks both the column (high part of r * N) and the
+  // threshold comparand (low byte), then one table lookup decides.
+  uint8_t AliasMarkov::getNextValue( void ) {
+    uint8_t n = pgm_read_byte( &_model->states ) ;
+
+    uint16_t scaled = rng.nextByte() * n ;
+    uint8_t col = scaled >> 8 ;
+    uint8_t frac = scaled & 0xFF ;
+    uint8_t threshold, alias ;
 
-    if( randVal < _current->previous.probability ){
-      _current = _current->previous.markovLink ;
+    if( _ramTable ){
+      const aliasEntry_t* e = &_ramTable[ _state * n + col ] ;
+      threshold = e->threshold ;
+      alias = e->alias ;
     }
-    else if( randVal < _current->previous.probability + _current->next.probability ){
-      _current = _current->next.markovLink ;
+    else{
+      const aliasEntry_t* e = (const aliasEntry_t*)pgm_read_word( &_model->table ) + _state * n + col ;
+      threshold = pgm_read_byte( &e->threshold ) ;
+      alias = pgm_read_byte( &e->alias ) ;
     }
 
-    return _current->value ;
+    _state = frac < threshold ? col : alias ;
 
-  }
+    return getValue() ;
 
-  int LinkedMarkov::getListSize( void ) const {
-      return _itr ;
   }
 
+  uint8_t AliasMarkov::getValue( void ) const {
+    const uint8_t* values = (const uint8_t*)pgm_read_word( &_model->values ) ;
+    return pgm_read_byte( &values[ _state ] ) ;
+  }
 
-  markovLink_t* LinkedMarkov::getMarkovPtr( uint8_t Pos ) {
-      assert( Pos < _itr ) ;
-      markovLink_t* temp = &_mValue[ Pos ] ;
-
-      return  temp ;
-
+  uint8_t AliasMarkov::getState( void ) const {
+    return _state ;
   }
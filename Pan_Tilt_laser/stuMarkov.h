@@ -10,6 +10,11 @@
 
     @section  HISTORY
     v0.0.1 - First release
+    v0.1.0 - Added AliasMarkov: dense N-state chains sampled from PROGMEM
+             alias tables.
+    v0.1.1 - LinkedMarkov links are 5 bytes: byte indices instead of
+             pointers, byte values and probabilities.
+    v0.2.0 - Removed LinkedMarkov; every chain is an AliasMarkov.
 
 */
 /**************************************************************************/
@@ -19,53 +24,46 @@
 #include "Arduino.h"
 //#endif
 
-#include <assert.h>
+#include <avr/pgmspace.h>
+#include "stu_random.h"
 
-  #define LINKED_LIST_SIZE 5
+// One column of a row's alias table. A draw landing in column c keeps c when
+// its fractional part is below threshold, otherwise it moves to alias. Full
+// columns alias to themselves.
+typedef struct aliasEntry_t{
 
-struct markovLink_t;
+          uint8_t            threshold;
+          uint8_t            alias;
 
-typedef struct markovPair_t{
+}aliasEntry_t;
 
-          unsigned  int       probability;
-          markovLink_t*       markovLink;
 
-}markovPair_t;
+// Dense transition model, everything in PROGMEM.
+typedef struct aliasModel_t{
 
+          uint8_t            states;
+  const   aliasEntry_t*      table;     // states x states, row = current state
+  const   uint8_t*           values;    // value returned for each state
 
-typedef struct markovLink_t{
+}aliasModel_t;
 
-          unsigned  int      value;
 
-
-          markovPair_t       previous;
-          markovPair_t       next;
-
-}markovLink_t;
-
-
-
-
-class LinkedMarkov {
+class AliasMarkov {
 
 public:
-                           LinkedMarkov( void ) ;
-
-            void           addLinkToBack( unsigned int value, unsigned int prevVal, unsigned int nextVal ) ;
+                           AliasMarkov( const aliasModel_t* model, uint8_t initialState = 0 ) ;
 
-  unsigned  int            getNextValue( void ) ;
-            int            getListSize( void ) const ;
-
-  markovLink_t*            getMarkovPtr( uint8_t relativePos ) ;
+            void           setState( uint8_t state ) ,
+                           setTable( const aliasEntry_t* ramTable ) ; // NULL => model table
 
+            uint8_t        getNextValue( void ) ,
+                           getValue( void ) const ,
+                           getState( void ) const ;
 
 private:
 
-        markovLink_t     _mValue[ LINKED_LIST_SIZE ] ;
-        markovLink_t*    _head ;
-        markovLink_t*    _tail ;
-        markovLink_t*    _current ;
-
-        int8_t           _itr ;
+  const aliasModel_t*      _model ;     // PROGMEM
+  const aliasEntry_t*      _ramTable ;  // optional RAM override (same shape)
+        uint8_t            _state ;
 
 };
@@ -12,69 +12,154 @@
 
     @section  HISTORY
     v0.0.1 - First release
+    v0.0.2 - Laser fades out/in around pauses when LASER_PWM is enabled.
+    v0.0.3 - Status LEDs run from their own ISR; update() no longer polls them.
+    v0.1.0 - Servo moves are queued setpoints stepped from a Timer0 compare
+             tick instead of blocking the loop.
+    v0.1.1 - State changes are reported as telemetry frames (TELEMETRY).
+    v0.1.2 - Diagnostics go through the buffered logger (stu_log.h).
+    v0.1.3 - State settings moved to PROGMEM, callbacks indexed by state.
+    v0.2.0 - Table-driven N-phase modes; durations are 32-bit (MINUTES()).
+    v0.2.1 - Warm boot skips the calibration sweep (WARM_BOOT, stu_boot.h).
+    v0.3.0 - Instance-safe for several turrets: SoA axis bank, shared dial
+             and LEDs, per-instance phase task, servo tick for all turrets.
 
 */
 /**************************************************************************/
 
 #include "stuPanTilt.h"
+#include "stu_telemetry.h"
+#include "stu_log.h"
+#include "stu_boot.h"
+
+
+static const settings_t on_state    PROGMEM = { STATE_RUN,  1, 1, { LED_ON,    LED_OFF, LED_OFF } };
+static const settings_t int_state   PROGMEM = { STATE_RUN,  1, 1, { LED_ON,    LED_ON,  LED_OFF } };
+static const settings_t sleep_state PROGMEM = { STATE_RUN,  1, 1, { LED_ON,    LED_OFF, LED_ON  } };
+static const settings_t off_state   PROGMEM = { STATE_OFF,  0, 0, { LED_OFF,   LED_OFF, LED_OFF } };
+static const settings_t rest_state  PROGMEM = { STATE_REST, 0, 0, { LED_BLINK, LED_ON,  LED_OFF } };
+
+// Indexed by runmode_e. A new schedule is a new row, e.g. 5 min on, 2 min
+// rest, 5 min on, 60 min off, repeat:
+//   { 4, 0, { { &on_state, MINUTES( 5 ) }, { &rest_state, MINUTES( 2 ) },
+//             { &on_state, MINUTES( 5 ) }, { &off_state, MINUTES( 60 ) } } }
+static const modeTable_t modeTable[] PROGMEM = {
+  /* MODE_OFF          */ { 1, MODE_NO_REPEAT, { { &off_state, 0 } } },
+  /* MODE_CONTINUOUS   */ { 1, MODE_NO_REPEAT, { { &on_state,  0 } } },
+  /* MODE_INTERMITTENT */ { 2, 0,              { { &int_state, MINUTES( INTERMITTENT_ON_TIME ) },
+                                                 { &rest_state, MINUTES( INTERMITTENT_OFF_TIME ) } } },
+  /* MODE_SLEEP        */ { 2, MODE_NO_REPEAT, { { &sleep_state, MINUTES( MINUTES_BEFORE_SLEEP ) },
+                                                 { &off_state, 0 } } }
+};
+
+static_assert( sizeof( modeTable ) / sizeof( modeTable[ 0 ] ) == MODE_SLEEP + 1, "modeTable needs one row per runmode_e" );
+
+axisBank_t axes;
+
+PanTilt* PanTilt::_turrets[ PANTILT_TURRETS ];
+volatile uint8_t PanTilt::_count = 0;
+StuDial PanTilt::_dial;
+StuDisplay PanTilt::_display;
+
+
+void PhaseTask::run( void ){
+  _enabled = 0;
+  _owner->callback();
+}
 
+static bool warmBoot; // decided once by the first turret
 
-static settings_t on_state( 1, LED_ON, LED_OFF, LED_OFF, STATE_RUN );
-static settings_t int_state( 1, LED_ON, LED_ON, LED_OFF, STATE_RUN );
-static settings_t sleep_state( 1, LED_ON, LED_OFF, LED_ON, STATE_RUN );
-static settings_t off_state( 0, LED_OFF, LED_OFF, LED_OFF, STATE_OFF);
-static settings_t rest_state( 0, LED_BLINK, LED_ON, LED_OFF, STATE_REST);
 
 PanTilt::PanTilt(uint8_t xPin, uint8_t yPin ):_xServo(), _yServo(),
-  _display( POWER_PIN,  CONT_PIN, INT_PIN ),
-  posX( SERVO_MIN_X_AXIS, SERVO_MAX_X_AXIS, -LASER_MIDPOINT_OFFSET_X-7, LASER_PROBABILITY_X ),
-  posY( SERVO_MIN_Y_AXIS, SERVO_MAX_Y_AXIS, -LASER_MIDPOINT_OFFSET_Y, LASER_PROBABILITY_Y),
-  _laser(LASER_PIN), _offMode( &off_state ), _contMode( &on_state ), _intMode( &int_state, INTERMITTENT_ON_TIME, &rest_state, INTERMITTENT_OFF_TIME ), _sleepMode(  &sleep_state, MINUTES_BEFORE_SLEEP, &off_state ), _stateChangeTask(), _currentState(&_currentMode->currentSettings->state->id) {
-
+  _laser(), _stateChangeTask( this ), _phase( 0 ), _state( STATE_OFF ), _id( 0 ) {
 
-  _modes[ 0 ] = &_offMode;
-  _modes[ 1 ] = &_contMode;
-  _modes[ 2 ] = &_intMode;
-  _modes[ 3 ] = &_sleepMode;
+  for( uint8_t i = 0; i < STATE_COUNT; i++ ){
+    _callbacks[ i ] = NULL;
+  }
 
   _xPin = xPin;
   _yPin = yPin;
 
-  _xServo.setCalibration(posX.minAngle, posX.maxAngle);
-  _yServo.setCalibration(posY.minAngle, posY.maxAngle);
-
 }
 
+// Call once per turret, in id order. The first call also sets up the
+// shared scheduler, dial and LEDs and decides warm or cold boot for all.
 void PanTilt::begin( void ){
 
-  scheduler.begin() ;
+  if( _count >= PANTILT_TURRETS ){
+    LOG( PANTILT, ERROR, "More turrets than PANTILT_TURRETS" );
+    return;
+  }
+  _id = _count;
+
+  if( _id == 0 ){
+    scheduler.begin() ;
+  }
   _laser.begin();
   _xServo.attach(_xPin) ;
   _yServo.attach(_yPin) ;
-  _xServo.setPowerPin( X_PWR_PIN ) ;
-  _yServo.setPowerPin( Y_PWR_PIN ) ;
-
-  _dial.setPin( DIAL_PIN );
-  _dial.begin() ;
+  _xServo.begin() ;
+  _yServo.begin() ;
+  axes.dirX[ _id ] = 1;
+  axes.dirY[ _id ] = 1;
+
+  // Servo tick: Timer0 compare B, once per millis() tick (1.024 ms), so
+  // servos still move one degree per ~ms. Pin 5 (OC0B) is not used as PWM.
+  // The ISR only sees this turret once _count includes it, so the pointer
+  // must be stored before _count is published.
+  _servoIdle = 1;
+  _turrets[ _id ] = this;
+  SPSC_BARRIER();
+  _count = _id + 1;
+  OCR0B = 0x40;
+  TIMSK0 |= _BV( OCIE0B );
 
-  _display.begin() ;
   scheduler.addEvent(&_stateChangeTask);
 
-  posX.angle = posX.minAngle;
-  posY.angle = posY.minAngle;
+  if( _id == 0 ){
+    _dial.setPin( DIAL_PIN );
+    _dial.begin() ;
+
+    // Same calibration and dial position as the last boot: no sweep, laser
+    // test or LED walk, just centre and go.
+    warmBoot = bootWarm( _dial.getMode() );
+
+    _display.begin( !warmBoot ) ;
+  }
+
+  if( warmBoot ){
+    LOGV( PANTILT, INFO, "Warm boot, turret ", _id );
+    angleX() = panTiltPosX_t::midAngle;
+    angleY() = panTiltPosY_t::midAngle;
+    _updateAngles();
+    return;
+  }
+
+  calibrate();
+  if( _id == 0 ){
+    bootSave( _dial.getMode() );
+  }
+
+}
+
+// Full sweep: both axes to their limits, centre, then a laser test
+void PanTilt::calibrate( void ){
+
+  angleX() = panTiltPosX_t::minAngle;
+  angleY() = panTiltPosY_t::minAngle;
 
   _updateAngles();
   delay(800);
 
-  posX.angle = posX.maxAngle;
-  posY.angle = posY.maxAngle;
+  angleX() = panTiltPosX_t::maxAngle;
+  angleY() = panTiltPosY_t::maxAngle;
   _updateAngles();
   delay(900);
 
 
 
-  posX.angle = posX.midAngle;
-  posY.angle = posY.midAngle;
+  angleX() = panTiltPosX_t::midAngle;
+  angleY() = panTiltPosY_t::midAngle;
   _updateAngles();
   delay(450);
   _laser.fire(1);
@@ -82,161 +167,112 @@ void PanTilt::begin( void ){
   delay(2000);
   _laser.fire(0);
 
-
 }
 
 void PanTilt::setStateCallback(state_e e , Callback f){
-  switch(e){
-
-    case STATE_RUN:
-      on_state.callback = f;
-      sleep_state.callback = f;
-      int_state.callback = f;
-      break;
-
-    case STATE_OFF:
-      off_state.callback = f;
-      break;
-
-    case STATE_REST:
-      rest_state.callback = f;
-      break;
-    }
+  if( e < STATE_COUNT ){
+    _callbacks[ e ] = f;
+  }
 }
 
 void PanTilt::_setMode( runmode_e mode ){
 
   _stateChangeTask.disable();
+  _mode = mode; // before _setState() so telemetry reports the new mode
 
-  switch(mode){
-
-    case MODE_OFF:
-      _laser.fire(0);
-      posX.angle = posX.midAngle;
-      posY.angle = posY.midAngle;
-      _updateAngles();
-      delay(250);
-      _setState(&off_state);
-      _currentMode = &_offMode;
-
-      #ifdef SERIAL_DEBUG
-        MY_SERIAL.println(F("MODE set to OFF"));
-      #endif
-      break;
-
-    case MODE_CONTINUOUS:
-
-      _setState(&on_state);
-      _currentMode = &_contMode;
-
-
-      #ifdef SERIAL_DEBUG
-        MY_SERIAL.println(F("MODE set to CONTINUOUS"));
-      #endif
-
-      break;
-
-    case MODE_INTERMITTENT:
-      _setState(&int_state);
-      _currentMode = &_intMode;
-
-      #ifdef SERIAL_DEBUG
-      MY_SERIAL.println(F("MODE set to INTERMITTENT"));
-      #endif
-
-      break;
-
-    case MODE_SLEEP:
-
-      _currentMode = &_sleepMode;
-      _setState(&sleep_state);
-
-      #ifdef SERIAL_DEBUG
-      MY_SERIAL.println(F("MODE set to SLEEP"));
-      #endif
-
-      break;
+  if( mode == MODE_OFF ){
+    _laser.fire(0);
+    angleX() = panTiltPosX_t::midAngle;
+    angleY() = panTiltPosY_t::midAngle;
+    _updateAngles();
+    delay(250);
   }
 
-  _currentMode->currentSettings = &_currentMode->settingA;
-  _currentMode->nextSettings = &_currentMode->settingB;
+  LOGV( PANTILT, INFO, "MODE set to ", mode );
+  if( _id == 0 ){
+    bootSave( mode );
+  }
 
-  _setState( _currentMode->currentSettings->state );
+  _phase = 0;
+  _enterPhase();
 
-  if( _currentMode->currentSettings->duration > 0){
-    _stateChangeTask.setInterval( _currentMode->currentSettings->duration );
-    _stateChangeTask.enable();
-    #ifdef SERIAL_DEBUG
-    MY_SERIAL.println(F("PanTilt setmode Enable\n"));
-    #endif
 }
 
-  _display.update();
-
-  _mode = mode;
-}
+// Apply the current phase and arm the timer for its duration
+void PanTilt::_enterPhase( void ){
+  const modePhase_t* p = &modeTable[ _mode ].phases[ _phase ];
+  time_t duration = pgm_read_dword( &p->duration );
 
+  _setState( (const settings_t*)pgm_read_word( &p->settings ) );
 
-Task* PanTilt::getTaskPtr( void ){
-  return &_stateChangeTask;
+  if( duration > 0 ){
+    _stateChangeTask.setInterval( duration );
+    _stateChangeTask.enable();
+    LOGV( PANTILT, DEBUG, "Phase timer (ms): ", duration );
+  }
 
 }
 
 
-Callback PanTilt::callback( void ){
+void PanTilt::callback( void ){
+  const modeTable_t* m = &modeTable[ _mode ];
+  uint8_t next = _phase + 1;
 
   _stateChangeTask.disable();
 
+  LOG( PANTILT, DEBUG, "STATE CALLBACK" );
 
-  #ifdef SERIAL_DEBUG
-    MY_SERIAL.println(F("STATE CALLBACK"));
-  #endif
-
-
-  statePair_t* tmp;
-  tmp = _currentMode->currentSettings;
-  _currentMode->currentSettings = _currentMode->nextSettings;
+  if( next >= pgm_read_byte( &m->count ) ){
+    next = pgm_read_byte( &m->repeat );
+    if( next == MODE_NO_REPEAT ){
+      return;
+    }
+  }
 
-  _setState( _currentMode->currentSettings->state );
+  _phase = next;
+  _enterPhase();
 
-  if( _currentMode->currentSettings->duration > 0){
-    _currentMode->nextSettings = tmp;
+}
 
-    _stateChangeTask.setInterval( _currentMode->currentSettings->duration );
 
-    #ifdef SERIAL_DEBUG
-    MY_SERIAL.println(F("PanTilt callback Enable\n"));
-    #endif
-    _stateChangeTask.enable();
-    delay(25);
-  }
-}
+void PanTilt::_setState( const settings_t* p ){
+  settings_t s;
 
+  memcpy_P( &s, p, sizeof( s ) );
+  _state = (state_e)s.id;
 
-void PanTilt::_setState( settings_t* s ){
+  TLM_STATE( s.id, _mode );
 
-  _display.setLEDStates( s->ledState[0], s->ledState[1], s->ledState[2] );
-  _laser.fire(s->laserState);
+  _display.setLEDStates( (ledState_e)s.ledState[0], (ledState_e)s.ledState[1], (ledState_e)s.ledState[2] );
+  _laser.fire(s.laserState);
 
-  if(s->servoState){
+  if(s.servoState){
     _xServo.wake();
     _yServo.wake();
   }else{
+    _waitIdle();
     _xServo.pause();
     _yServo.pause();
   }
-    s->callback();
+
+  if( _callbacks[ _state ] ){
+    _callbacks[ _state ]();
+  }
 
 }
 
 state_e PanTilt::getState( void ) const{
-  return _currentMode->currentSettings->state->id;
+  return _state;
+}
+
+uint8_t PanTilt::getId( void ) const{
+  return _id;
 }
 
 
 void PanTilt::setPosition( int X, int Y ){
-  posX.angle = 90;
-  posY.angle = 90;
+  angleX() = 90;
+  angleY() = 90;
 
 }
 
@@ -246,6 +282,7 @@ runmode_e PanTilt::getMode( void ) const{
 }
 
 void PanTilt::detach( void ){
+  _waitIdle();
   _xServo.detach();
   _yServo.detach();
 }
@@ -258,43 +295,92 @@ void PanTilt::update( void ){
   }
 
 
-  _display.update();
   if( getState() == STATE_RUN){
     _updateAngles();
   }
 }
 
+// Queue the current angles. Waits while the queue is full, so the loop
+// still can't run more than SETPOINT_QUEUE_SIZE moves ahead of the servos.
 void PanTilt::_updateAngles( void ){
+  setpoint_t sp;
 
-  _xServo.stuWrite(posX.angle);
-  _yServo.stuWrite(posY.angle);
+  sp.x = angleX();
+  sp.y = angleY();
+  while( _setpoints.full() ){
+  }
+  _setpoints.push( sp );
 
 }
 
+// Until every queued move has been stepped out.
+void PanTilt::_waitIdle( void ){
+  while( !_setpoints.empty() || !_servoIdle ){
+  }
+
+}
+
+// Next setpoint once both axes have arrived; both axes step together.
+void PanTilt::_servoTick( void ){
+
+  if( _xServo.atTarget() && _yServo.atTarget() ){
+    setpoint_t sp;
+    if( _setpoints.pop( sp ) ){
+      _xServo.setTarget( sp.x );
+      _yServo.setTarget( sp.y );
+    }
+  }
+
+  _xServo.step();
+  _yServo.step();
+
+  _servoIdle = _xServo.atTarget() && _yServo.atTarget();
+}
+
+
+ISR( TIMER0_COMPB_vect ){
+  uint8_t count = PanTilt::_count;
+
+  for( uint8_t i = 0; i < count; i++ ){
+    PanTilt::_turrets[ i ]->_servoTick();
+  }
+}
+
 void PanTilt::pause( unsigned long pauseVal, bool laserState ){
   if(PanTilt::getState() != STATE_RUN){
     return;
   }
-  _laser.fire(laserState);
+  if( laserState ){
+    _laser.fire(1);
+  }
+  else{
+    _laser.fade(0);
+  }
+  _waitIdle();
   _xServo.pause();
   _yServo.pause();
   delay( pauseVal );
   _xServo.wake();
   _yServo.wake();
-  _laser.fire(1);
+  if( laserState ){
+    _laser.fire(1);
+  }
+  else{
+    _laser.fade(1);
+  }
 
 }
 
 void PanTilt::shake( void ){
   int moveVal = 20;
   const int shakeDelay = 0;
-  posX.angle += moveVal;
+  angleX() += moveVal;
   PanTilt::update();
   delay(shakeDelay);
-  posX.angle -= 2*moveVal;
+  angleX() -= 2*moveVal;
   PanTilt::update();
   delay(shakeDelay);
-  posX.angle += moveVal;
+  angleX() += moveVal;
   PanTilt::update();
   delay(shakeDelay);
 }
@@ -12,6 +12,14 @@
 
     @section  HISTORY
     v0.0.1 - First release
+    v0.1.0 - Servo moves are queued setpoints stepped from a Timer0 compare
+             tick instead of blocking the loop.
+    v0.1.1 - State settings live in PROGMEM; callbacks are per instance.
+    v0.2.0 - Modes are PROGMEM phase tables (modeTable_t) replacing the
+             two-phase mode_t.
+    v0.2.1 - begin() skips the calibration sweep on a warm boot.
+    v0.3.0 - Several instances (PANTILT_TURRETS) share the dial, LEDs and
+             scheduler; axis state is a structure-of-arrays bank (axes).
 
 */
 /**************************************************************************/
@@ -27,87 +35,133 @@
 #include "stu_dial.h"
 #include "stuLaser.h"
 #include "SETTINGS.h"
+#include "stu_spsc.h"
 
+#define SETPOINT_QUEUE_SIZE 4 // servo setpoints buffered ahead of the tick
 
+#define MODE_MAX_PHASES 4     // phases per mode table row
+#define MODE_NO_REPEAT  0xFF  // modeTable_t::repeat: stay in the last phase
 
+// Phase durations in ms from minutes, unsigned long throughout (an int
+// product overflows at 33 s on AVR).
+#define MINUTES( m ) ( (time_t)( m ) * 60UL * 1000UL )
 
-  struct panTiltPos_t {
-    int
-      pos,
-      angle,
-      dir;
 
-    const int
-      minAngle,
-      maxAngle,
-      midOffset,
-      midAngle,
-      probOffset;
 
 
-    panTiltPos_t( int mn, int mx, int mdOff = 0, int pbOff = 1): pos( 0 ), dir(1), minAngle(mn), maxAngle(mx), midOffset(mdOff), midAngle(((mx-mn) >>1) + mn + midOffset), probOffset(pbOff){}
+  // Axis limits are template parameters so clamping, midpoint and
+  // probability math constant-fold. The type carries no state; the moving
+  // state of every turret is in the axes bank below.
+  template< int MN, int MX, int MD_OFF = 0, int PB_OFF = 1 >
+  struct panTiltAxis_t {
+
+    static const int
+      minAngle = MN,
+      maxAngle = MX,
+      midOffset = MD_OFF,
+      midAngle = ((MX-MN) >>1) + MN + MD_OFF,
+      probOffset = PB_OFF;
 
   };
 
+  template< int MN, int MX, int MD_OFF, int PB_OFF > const int panTiltAxis_t< MN, MX, MD_OFF, PB_OFF >::minAngle;
+  template< int MN, int MX, int MD_OFF, int PB_OFF > const int panTiltAxis_t< MN, MX, MD_OFF, PB_OFF >::maxAngle;
+  template< int MN, int MX, int MD_OFF, int PB_OFF > const int panTiltAxis_t< MN, MX, MD_OFF, PB_OFF >::midOffset;
+  template< int MN, int MX, int MD_OFF, int PB_OFF > const int panTiltAxis_t< MN, MX, MD_OFF, PB_OFF >::midAngle;
+  template< int MN, int MX, int MD_OFF, int PB_OFF > const int panTiltAxis_t< MN, MX, MD_OFF, PB_OFF >::probOffset;
+
+  typedef panTiltAxis_t< SERVO_MIN_X_AXIS, SERVO_MAX_X_AXIS, -LASER_MIDPOINT_OFFSET_X-7, LASER_PROBABILITY_X > panTiltPosX_t;
+  typedef panTiltAxis_t< SERVO_MIN_Y_AXIS, SERVO_MAX_Y_AXIS, -LASER_MIDPOINT_OFFSET_Y, LASER_PROBABILITY_Y > panTiltPosY_t;
+
+
+  // Target angle and walk direction of every turret's axes, one array per
+  // field and indexed by turret id, so a motion generator updates all heads
+  // in one pass over contiguous arrays.
+  typedef struct axisBank_t{
+    int16_t
+      angleX[ PANTILT_TURRETS ],
+      angleY[ PANTILT_TURRETS ];
+
+    int8_t
+      dirX[ PANTILT_TURRETS ],
+      dirY[ PANTILT_TURRETS ];
+  }axisBank_t;
+
+  extern axisBank_t axes;
+
+
+  // Target angles for both axes, handed to the servo tick
+  typedef struct setpoint_t{
+    int16_t
+      x,
+      y;
+  }setpoint_t;
+
 
 typedef enum {
   STATE_OFF,
   STATE_RUN,
-  STATE_REST
+  STATE_REST,
+  STATE_COUNT
 }state_e;
 
 
 
+// Output settings for one state. Constant, so kept in PROGMEM and read with
+// memcpy_P; the state callbacks are set at run time and live in PanTilt.
 typedef struct settings_t{
-      state_e
-        id;
-
-      bool const
+      uint8_t
+        id,           // state_e
         laserState,
-        servoState;
+        servoState,
+        ledState[3];  // ledState_e
+    } settings_t;
 
-      Callback
-        callback;
 
-      ledState_e
-        ledState[3];
+// One step of a mode: a state held for duration ms (0 = until the mode
+// changes).
+typedef struct modePhase_t{
+      const settings_t*
+        settings;     // PROGMEM
 
-      settings_t(bool laser, ledState_e e0, ledState_e e1, ledState_e e2, state_e e):laserState(laser), servoState(laser), id(e), callback(NULL){
-        ledState[0] = e0;
-        ledState[1] = e1;
-        ledState[2] = e2;
+      time_t
+        duration;
+    } modePhase_t;
 
-      }
-    } settings_t;
 
+// A run mode as a sequence of phases, kept in PROGMEM and indexed by
+// runmode_e. After the last phase the sequence restarts at phase `repeat`,
+// or stops there with MODE_NO_REPEAT.
+typedef struct modeTable_t{
+      uint8_t
+        count,
+        repeat;
 
-    typedef struct statePair_t{
-      settings_t*
-        state;
+      modePhase_t
+        phases[ MODE_MAX_PHASES ];
+    } modeTable_t;
 
-      time_t const
-        duration;
 
-      statePair_t(settings_t* s, time_t t=0): state(s), duration( t ){}
 
-    };
 
-  typedef struct mode_t{
+  class PanTilt;
 
-      statePair_t
-        settingA,
-        settingB;
+  // Mode phase timer; runs the owning turret's callback()
+  class PhaseTask: public Event{
 
-      statePair_t* currentSettings;
-      statePair_t* nextSettings;
+  public:
 
+    PhaseTask( PanTilt* owner ): _owner( owner ) {}
 
-        mode_t(settings_t* s1, time_t duration1=0, settings_t* s2=NULL, time_t duration2=0 ):settingA(s1, duration1*60*1000), settingB(s2, duration2*60*1000), currentSettings(&settingA), nextSettings(&settingB){
+    virtual void
+      run( void ) ;
 
-        }
-  };
+  private:
 
+    PanTilt*
+      _owner ;
 
+  };
 
 
   class PanTilt {
@@ -118,6 +172,7 @@ typedef struct settings_t{
 
     void
       begin( void ),
+      calibrate( void ),
       detach( void ),
       update( void ),
       shake( void ),
@@ -125,8 +180,11 @@ typedef struct settings_t{
       pause( unsigned long pauseVal, bool laserState = 1 ),
       setStateCallback(state_e e , Callback f) ;
 
-    panTiltPos_t* getXPos( void );
-    panTiltPos_t* getYPos( void );
+    int16_t& angleX( void ) { return axes.angleX[ _id ]; }
+    int16_t& angleY( void ) { return axes.angleY[ _id ]; }
+
+    uint8_t
+      getId( void ) const;
 
     runmode_e
       getMode( void ) const;
@@ -134,34 +192,34 @@ typedef struct settings_t{
     state_e
       getState( void ) const;
 
-      Callback
-        callback( void );
-
-    Task* getTaskPtr( void );
+    void
+      callback( void ); // phase timer elapsed
 
+    void
+      _servoTick( void ); // Timer0 compare B (called from ISR)
 
+    static PanTilt*
+      _turrets[ PANTILT_TURRETS ]; // begun instances, by id
 
-      panTiltPos_t
-        posX ,
-        posY ;
+    static volatile uint8_t
+      _count; // published after _turrets[ id ] for the servo tick ISR
 
   private:
 
-    StuDisplay _display ;
+    // One control panel for all turrets: the first begin() sets them up
+    static StuDisplay
+      _display ;
 
     void
       _setMode( runmode_e mode ),
-      _setState( settings_t* s );
+      _setState( const settings_t* s ),
+      _enterPhase( void );
 
-    mode_t
-      _offMode,
-      _contMode,
-      _intMode,
-      _sleepMode;
 
+    StuAxisServo< panTiltPosX_t, X_PWR_PIN >
+      _xServo;
 
-    StuServo
-      _xServo,
+    StuAxisServo< panTiltPosY_t, Y_PWR_PIN >
       _yServo;
 
     uint8_t
@@ -169,29 +227,39 @@ typedef struct settings_t{
       _yPin;
 
     void
-      _updateAngles( void );
+      _updateAngles( void ),
+      _waitIdle( void );
+
+    StuSpsc< setpoint_t, SETPOINT_QUEUE_SIZE >
+      _setpoints;
 
+    volatile bool
+      _servoIdle;
 
 
-    mode_t*
-      _modes[ 4 ];
 
-    mode_t*
-      _currentMode;
+    uint8_t
+      _phase; // index into the current mode's phases
 
-    Task
+    PhaseTask
       _stateChangeTask;
 
     runmode_e
       _mode; // pan tilt mode
 
-    state_e* const
-      _currentState;
+    state_e
+      _state; // cached id of the current settings
+
+    Callback
+      _callbacks[ STATE_COUNT ];
+
+    uint8_t
+      _id; // index into axes and _turrets
 
-    StuDial
+    static StuDial
       _dial ;
 
-    StuLaser
+    StuLaser< LASER_PIN >
       _laser ;
 
 
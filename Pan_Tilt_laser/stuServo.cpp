@@ -14,6 +14,13 @@ v0.0.1 - First release
 v0.0.2 - Switched write to writeMicroseconds to allow maximal servo
 rotation.
 v0.0.3 - Added 5 microsecond delay after wake to allow capacitors to charge.
+v0.1.0 - Limits are now template parameters (StuAxisServo) so clamping
+constant-folds and no calibration is stored in RAM.
+v0.1.1 - Power pin is a template parameter (FastPin).
+v0.2.0 - Non-blocking: setTarget() plus step() from a timer tick
+replaces the 1 degree/ms delay() loop.
+v0.2.1 - step() writes microseconds from a constant fixed-point scale
+instead of Servo::write()'s 32 bit map() divide.
 
 */
 /**************************************************************************/
@@ -21,71 +28,20 @@ v0.0.3 - Added 5 microsecond delay after wake to allow capacitors to charge.
 #include "stuServo.h"
 
 
-void StuServo::setPowerPin( uint8_t powerPin ){
+// Degrees to pulse width for attach()'s default MIN/MAX_PULSE_WIDTH, the
+// same mapping as Servo::write() to within 1 us. The scale is 8.8 fixed
+// point and constant, so this is one 16x16 multiply rather than map()'s
+// 32 bit divide (tens of us, too long for the servo tick ISR).
+#define SERVO_US_SCALE ( ( ( MAX_PULSE_WIDTH - MIN_PULSE_WIDTH ) * 256UL ) / 180 )
 
-  _powerPin = powerPin ;
-  pinMode( _powerPin, OUTPUT ) ;
-  digitalWrite( _powerPin, HIGH ) ;
-
-}
-
-
-void StuServo::setCalibration( int min, int max ){
-  _position.min = min;
-  _position.max = max;
-
-}
-
-void StuServo::pause( void ){
-  digitalWrite( _powerPin, LOW ) ;
-}
-
-void StuServo::wake( void ){
-  digitalWrite( _powerPin, HIGH ) ;
-  delay(10);
-}
-
-
-void StuServo::stuWrite( int position ){
-  int curPos = read();
-  int newPos;
-
-
-  if( position < _position.min ){
-    newPos = _position.min ;
+// One degree towards the (already clamped) target.
+void StuServo::step( void ){
 
+  if( _pos == _target ){
+    return;
   }
-  else if( position > _position.max ){
-
-    newPos = _position.max ;
-  }
-  else{
-
-    newPos =  position ;
-  }
-
-  int diff = newPos - curPos;
-  int sign = 1;
-  if( diff < 0){
-    sign = -1;
-    diff *= sign;
-  }
-
-  while( curPos != newPos ){
-    write( curPos );
-    curPos += sign;
-    delay(1);
-  }
-
-
-}
-
-
-int StuServo::getMin( void ) const {
-  return _position.min ;
-}
 
+  _pos += _pos < _target ? 1 : -1;
+  writeMicroseconds( MIN_PULSE_WIDTH + (int)( ( (uint32_t)(uint8_t)_pos * SERVO_US_SCALE ) >> 8 ) );
 
-int StuServo::getMax( void ) const {
-  return _position.max ;
 }
@@ -15,6 +15,13 @@
              rotation.
     v0.0.3 - Added 5 microsecond delay after wake to allow capacitors to charge.
     v0.0.4 - Added a readMicroseconds function to get position.
+    v0.1.0 - Limits are now template parameters (StuAxisServo) so clamping
+             constant-folds and no calibration is stored in RAM.
+    v0.1.1 - Power pin is a template parameter (FastPin).
+    v0.2.0 - Non-blocking: setTarget() plus step() from a timer tick
+             replaces the 1 degree/ms delay() loop.
+    v0.2.1 - step() writes microseconds from a constant fixed-point scale
+             instead of Servo::write()'s 32 bit map() divide.
 
 */
 /**************************************************************************/
@@ -24,43 +31,69 @@
 
 #include "Arduino.h"
 #include <Servo.h>
-#include "Arduino.h"
-
-struct servoPos{
-
-    int
-      min ,
-      max ,
-      current ;
-};
+#include "stu_fastpin.h"
 
+// Moves one degree per step() towards the target. step() is called from the
+// PanTilt servo tick ISR; _pos and _target are only touched there once the
+// tick is running.
 class StuServo: public Servo {
 
 public:
 
     void
-      begin( void ) ,
-      setPowerPin( uint8_t pwrPin ) ,
-      setCalibration( int min, int max ) ,
-      stuWrite( int position ),
-      pause( void ),
-      wake( void ) ;
+      step( void ) ;
 
+    bool atTarget( void ) const {
+      return _pos == _target ;
+    }
+
+protected:
 
     int
-      getMin( void ) const ,
-      getMax( void ) const ;
+      _pos ,
+      _target ;
 
+};
 
-private:
 
-    servoPos
-      _position ;
+// Servo bound to an axis type (see panTiltAxis_t) and its power pin. The
+// limits come from AXIS::minAngle/maxAngle at compile time.
+template< class AXIS, uint8_t PWR_PIN >
+class StuAxisServo: public StuServo {
 
-    uint8_t
-      _powerPin ;
+public:
 
-    int
-      _microSeconds ;
+    void begin( void ){ // power on, call after attach()
+      FastPin< PWR_PIN >::output() ;
+      FastPin< PWR_PIN >::high() ;
+      _pos = _target = read() ;
+    }
+
+    void pause( void ){
+      FastPin< PWR_PIN >::low() ;
+    }
+
+    void wake( void ){
+      FastPin< PWR_PIN >::high() ;
+      delay(10);
+    }
+
+    void setTarget( int position ){
+      if( position < AXIS::minAngle ){
+        position = AXIS::minAngle ;
+      }
+      else if( position > AXIS::maxAngle ){
+        position = AXIS::maxAngle ;
+      }
+      _target = position ;
+    }
+
+    static int getMin( void ){
+      return AXIS::minAngle ;
+    }
+
+    static int getMax( void ){
+      return AXIS::maxAngle ;
+    }
 
 };
@@ -0,0 +1,81 @@
+/**************************************************************************/
+/*!
+    @file     stu_boot.cpp
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Warm boot record. The calibration signature of the build, the last run
+    mode and the RNG state are kept in EEPROM behind a CRC.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+    v0.0.2 - Calibration signature table lives in PROGMEM.
+
+*/
+/**************************************************************************/
+
+#include "stu_boot.h"
+
+static_assert( sizeof( bootRecord_t ) + 2 <= EEPROM_BOOT_SIZE, "bootRecord_t does not fit its EEPROM block" ) ;
+
+static bootRecord_t record ;
+static bool recordValid = false ;
+
+
+// Anything the boot sweep exists to check. A change in SETTINGS.h gives a
+// new signature and so one cold boot. Kept in flash; same bytes and CRC as
+// crc16() would see in RAM.
+static const int16_t calibration[] PROGMEM = {
+  BOOT_VERSION,
+  SERVO_MIN_X_AXIS, SERVO_MAX_X_AXIS, LASER_MIDPOINT_OFFSET_X,
+  SERVO_MIN_Y_AXIS, SERVO_MAX_Y_AXIS, LASER_MIDPOINT_OFFSET_Y
+} ;
+
+uint16_t bootCalibration( void ){
+  const uint8_t* p = (const uint8_t*)calibration ;
+  uint16_t crc = 0xFFFF ;
+
+  for( uint8_t i = 0; i < sizeof( calibration ); i++ ){
+    crc = _crc16_update( crc, pgm_read_byte( p + i ) ) ;
+  }
+  return crc ;
+}
+
+void bootLoad( void ){
+#ifdef WARM_BOOT
+  recordValid = eepromReadBlock( EEPROM_BOOT_ADDR, &record, sizeof( record ) ) &&
+                record.version == BOOT_VERSION ;
+
+  // A floating ADC pin alone gives a few bits of seed; the saved state
+  // keeps sequences from repeating across power cycles.
+  if( recordValid ){
+    rng.seed( rng.getState() ^ record.rngState ) ;
+  }
+#endif
+}
+
+bool bootWarm( uint8_t mode ){
+  return recordValid && record.calibration == bootCalibration() && record.mode == mode ;
+}
+
+// Called at boot and on mode changes (the dial), so the writes are rare;
+// unchanged bytes are skipped by eepromWriteBlock().
+void bootSave( uint8_t mode ){
+#ifdef WARM_BOOT
+  record.version = BOOT_VERSION ;
+  record.calibration = bootCalibration() ;
+  record.mode = mode ;
+  record.rngState = rng.next() ;
+  eepromWriteBlock( EEPROM_BOOT_ADDR, &record, sizeof( record ) ) ;
+  recordValid = true ;
+#endif
+}
+
+void bootInvalidate( void ){
+#ifdef WARM_BOOT
+  record.version = 0 ;
+  eepromWriteBlock( EEPROM_BOOT_ADDR, &record, sizeof( record ) ) ;
+  recordValid = false ;
+#endif
+}
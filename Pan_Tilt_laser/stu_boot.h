@@ -0,0 +1,62 @@
+/**************************************************************************/
+/*!
+    @file     stu_boot.h
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Warm boot record. The calibration signature of the build, the last run
+    mode and the RNG state are kept in EEPROM behind a CRC. When the record
+    is intact, the signature matches and the dial still selects the saved
+    mode, PanTilt::begin() skips the servo sweep, the laser test and the
+    LED walk (about 6.5 s) and the toy is running within a few hundred ms.
+
+    A bad CRC, a changed calibration or a changed mode gives the full
+    cold boot. PARAM_CMD_RECALIBRATE (stu_params.h) clears the record so
+    the next power-up calibrates.
+
+    Enabled with WARM_BOOT; otherwise every boot is a cold boot.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+
+*/
+/**************************************************************************/
+#pragma once
+
+#include "Arduino.h"
+#include "panTilt_config.h"
+#include "SETTINGS.h"
+#include "stu_eeprom.h"
+#include "stu_random.h"
+
+#define BOOT_VERSION 1
+
+
+typedef struct bootRecord_t{
+
+  uint8_t
+    version ;
+
+  uint16_t
+    calibration ;   // bootCalibration() of the build that wrote it
+
+  uint8_t
+    mode ;          // runmode_e at the last save
+
+  uint32_t
+    rngState ;      // carried into the next boot's seed
+
+}bootRecord_t;
+
+
+uint16_t
+  bootCalibration( void ) ;         // signature of the servo limits and offsets
+
+void
+  bootLoad( void ) ,                // read the record, mix its RNG state into rng
+  bootSave( uint8_t mode ) ,        // store mode, calibration and rng state
+  bootInvalidate( void ) ;          // force a cold boot next time
+
+bool
+  bootWarm( uint8_t mode ) ;        // record valid for this build and mode
@@ -6,15 +6,29 @@
 
 Library to read input from potentiometer and return appropriate run mode.
 
+The ADC free-runs and every conversion is checked for the OFF position
+(laser kill path); every DIAL_DECIMATE-th conversion is queued for the
+median, hysteresis and debounce mode filter, which getMode() runs.
+
 
 @section  HISTORY
 v0.0.1 - First release
+v0.1.0 - Interrupt-driven sampling with median filter and hysteresis.
+v0.2.0 - Free-running ADC with laser kill latch on raw OFF readings.
+v0.2.1 - Filter moved out of the ISR; samples handed over by StuSpsc.
+v0.2.2 - Diagnostics go through the buffered logger (stu_log.h).
+v0.2.3 - Kill latency estimate includes the servo tick and other ISRs.
 
 */
 /**************************************************************************/
 
 #include "stu_dial.h"
+#include "stu_log.h"
+#include "stu_fastpin.h"
+#include <util/atomic.h>
 
+StuDial* StuDial::_instance = NULL;
+volatile bool StuDial::_killed = false;
 
 
 void StuDial::setPin( uint8_t dialPin ){
@@ -24,9 +38,28 @@ void StuDial::setPin( uint8_t dialPin ){
 
 void StuDial::begin( void ){
   pinMode( _dialPin, INPUT ) ;
-  StuDial::_update() ;
+  StuDial::_update() ; // one blocking read so the first mode is known
   //analogReference(INTERNAL);
 
+  for( uint8_t i = 0; i < DIAL_MEDIAN_SAMPLES; i++ ){
+    _samples[ i ] = analogRead( _dialPin ) ;
+  }
+  _sampleItr = 0 ;
+  _candidate = _mode ;
+  _debounce = 0 ;
+  _decimate = 0 ;
+  _killCount = 0 ;
+  _killed = ( _mode == MODE_OFF ) ;
+  _instance = this ;
+
+  // AVcc reference, dial channel, free running, prescaler 128 (125 kHz ADC
+  // clock, 13 cycles = 104 us per conversion).
+  DIDR0 |= _BV( _dialPin - A0 ) ;
+  ADMUX = _BV( REFS0 ) | ( ( _dialPin - A0 ) & 0x07 ) ;
+  ADCSRB = 0 ;
+  ADCSRA = _BV( ADEN ) | _BV( ADATE ) | _BV( ADIE ) | _BV( ADIF ) |
+           _BV( ADPS2 ) | _BV( ADPS1 ) | _BV( ADPS0 ) ;
+
 }
 
 void StuDial::_update( void ){
@@ -51,12 +84,7 @@ void StuDial::_update( void ){
     int adcReading = sumRead >> 2; //divide by 4 (6 readings - hi - lo = 4 readings)
 
 
-#ifdef SERIAL_DEBUG
-#ifdef DIAL_DEBUG
-  MY_SERIAL.println(F("Reading:"));
-  MY_SERIAL.println(adcReading);
-#endif
-#endif
+  LOGV( DIAL, DEBUG, "Reading: ", adcReading );
 
   if( adcReading <= ADC_VALUE_RANGE ){ // 0 == MODE_OFF
     _mode = MODE_OFF ;
@@ -76,7 +104,135 @@ void StuDial::_update( void ){
 
 }
 
+bool StuDial::_inBand( uint8_t mode, int reading, int margin ){
+
+  switch( mode ){
+
+    case MODE_OFF:
+      return reading <= ADC_VALUE_RANGE + margin ;
+
+    case MODE_CONTINUOUS:
+      return abs( reading - MAX_CONT_ADC ) <= ADC_VALUE_RANGE + margin ;
+
+    case MODE_INTERMITTENT:
+      return abs( reading - MAX_INT_ADC ) <= ADC_VALUE_RANGE + margin ;
+
+    case MODE_SLEEP:
+      return reading >= MAX_SLEEP_ADC - ADC_VALUE_RANGE - margin ;
+  }
+  return false ;
+}
+
+// ~9.6 kHz. Kill check on every raw conversion. Every DIAL_DECIMATE-th
+// reading (~1 kHz) is queued for _filter().
+//
+// From the wiper reaching OFF to the pin going low: the conversion in
+// progress plus DIAL_KILL_SAMPLES conversions (4 x 104 us; the conversion
+// count is checked by Extra/Tools/dial_test.sh), plus the time ADC_vect
+// waits behind higher priority vectors. That wait is an unmeasured cycle
+// estimate at 16 MHz: servo tick ~20 us per turret (TIMER0_COMPB), Servo
+// pulse ~8 us, LEDs ~6 us, millis ~5 us, USART ~10 us, LASER_PWM ~10 us,
+// ADC_vect itself ~4 us, so roughly 480 us with one turret. Not verified on
+// hardware or in a simulator.
+void StuDial::_isr( uint16_t reading ){
+
+  if( reading <= ADC_VALUE_RANGE ){
+    if( _killCount < DIAL_KILL_SAMPLES && ++_killCount == DIAL_KILL_SAMPLES ){
+      FastPin< LASER_PIN >::low() ;
+#if defined( LASER_PWM ) && LASER_PIN == 11
+      TCCR2A &= ~_BV( COM2A1 ) ; // release OC2A so the pin stays low
+#endif
+      _killed = true ;
+    }
+  }
+  else{
+    _killCount = 0 ;
+  }
+
+  if( ++_decimate < DIAL_DECIMATE ){
+    return ;
+  }
+  _decimate = 0 ;
+  _queue.push( reading ) ;
+}
+
+// Median of the window, stay in the current mode while inside its widened
+// band, otherwise a new band must win DIAL_DEBOUNCE samples in a row.
+void StuDial::_filter( uint16_t reading ){
+  uint16_t sorted[ DIAL_MEDIAN_SAMPLES ] ;
+
+  if( _killed && _mode != MODE_OFF && _inBand( _mode, reading, DIAL_HYSTERESIS ) ){
+    _release() ;                        // glitch, or mode already left OFF
+  }
+
+  _samples[ _sampleItr ] = reading ;
+  if( ++_sampleItr >= DIAL_MEDIAN_SAMPLES ){
+    _sampleItr = 0 ;
+  }
+
+  for( uint8_t i = 0; i < DIAL_MEDIAN_SAMPLES; i++ ){ // insertion sort
+    uint16_t v = _samples[ i ] ;
+    int8_t j = i - 1 ;
+    while( j >= 0 && sorted[ j ] > v ){
+      sorted[ j + 1 ] = sorted[ j ] ;
+      j-- ;
+    }
+    sorted[ j + 1 ] = v ;
+  }
+  int median = sorted[ DIAL_MEDIAN_SAMPLES >> 1 ] ;
+
+  if( _inBand( _mode, median, DIAL_HYSTERESIS ) ){
+    _debounce = 0 ;
+    return ;
+  }
+
+  for( uint8_t m = MODE_OFF; m <= MODE_SLEEP; m++ ){
+    if( _inBand( m, median, 0 ) ){
+      if( m != _candidate ){
+        _candidate = m ;
+        _debounce = 0 ;
+      }
+      if( ++_debounce >= DIAL_DEBOUNCE ){
+        if( m != MODE_OFF ){
+          _release() ;                  // before the caller sees the new mode
+        }
+        _mode = (runmode_e)m ;
+        _debounce = 0 ;
+      }
+      return ;
+    }
+  }
+  // between bands: keep the current mode (same as the blocking version)
+}
+
+// Clear the kill latch unless the ISR is currently seeing OFF readings.
+// Atomic so a kill can't land between the check and the clear.
+void StuDial::_release( void ){
+  ATOMIC_BLOCK( ATOMIC_RESTORESTATE ){
+    if( _killCount == 0 ){
+      _killed = false ;
+    }
+  }
+}
+
 runmode_e StuDial::getMode( void ){
-  StuDial::_update();
+  uint16_t reading ;
+
+  while( _queue.pop( reading ) ){
+    _filter( reading ) ;
+  }
   return _mode ;
 }
+
+bool StuDial::killed( void ){
+  return _killed ;
+}
+
+
+ISR( ADC_vect ){
+  uint16_t reading = ADC ;
+
+  if( StuDial::_instance ){
+    StuDial::_instance->_isr( reading ) ;
+  }
+}
@@ -6,9 +6,30 @@
 
 Library to read input from potentiometer and return appropriate run mode.
 
+The ADC free-runs (104 us per conversion) and the conversion-complete ISR
+does two things. Every conversion is checked against the OFF band: after
+DIAL_KILL_SAMPLES raw OFF readings in a row the laser pin is cut directly
+from the ISR and the kill latch is set, no matter what the main loop is
+blocked in (4 conversions, ~420 us, plus interrupt latency; see _isr()). Every
+DIAL_DECIMATE-th conversion (~1 kHz) is pushed into a lock-free queue.
+getMode() drains the queue through the mode filter (median of the last
+DIAL_MEDIAN_SAMPLES, then mode selection with hysteresis and debouncing),
+so the filter runs in the main loop rather than in the ISR. Samples that
+arrive while the queue is full (long blocking pauses) are dropped.
+
+While killed() is set the laser drivers refuse to turn the laser on. The
+latch is released once the debounced mode is something other than OFF.
+
+Note: analogRead() must not be used on other pins after begin() since the
+ADC is owned by the dial.
+
 
 @section  HISTORY
 v0.0.1 - First release
+v0.1.0 - Interrupt-driven sampling with median filter and hysteresis.
+v0.2.0 - Free-running ADC with laser kill latch on raw OFF readings.
+v0.2.1 - Filter moved out of the ISR; samples handed over by StuSpsc.
+v0.2.2 - Diagnostics go through the buffered logger (stu_log.h).
 
 */
 /**************************************************************************/
@@ -17,10 +38,9 @@ v0.0.1 - First release
 
 #include "Arduino.h"
 #include "panTilt_config.h"
+#include "stu_spsc.h"
 
 
-#define DIAL_DEBUG
-
 #define ADC_VALUE_RANGE 7
 
 // ADC readings from selecter potentiometer
@@ -29,6 +49,13 @@ v0.0.1 - First release
 #define MAX_INT_ADC  165 // * ADC_SAMPLES // If less than, mode = INTERMITTENT
 #define MAX_SLEEP_ADC  295 // * ADC_SAMPLES // If less than, mode = INTERMITTENT
 
+#define DIAL_MEDIAN_SAMPLES 5  // running median window (samples)
+#define DIAL_HYSTERESIS     6  // extra ADC counts before leaving current mode
+#define DIAL_DEBOUNCE       20 // consecutive samples (~ms) before a mode change
+#define DIAL_DECIMATE       10 // conversions per filter sample (9.6 kHz -> ~1 kHz)
+#define DIAL_KILL_SAMPLES   3  // consecutive raw OFF conversions before the laser is cut
+#define DIAL_QUEUE_SIZE     16 // filter samples buffered between ISR and getMode()
+
 
 class StuDial{
 
@@ -42,15 +69,46 @@ public:
   runmode_e
     getMode( void );
 
+  static bool
+    killed( void ) ;
+
+  void
+    _isr( uint16_t reading ) ; // ADC conversion complete (called from ISR)
+
+  static StuDial*
+    _instance ;
+
+  static volatile bool
+    _killed ;
 
 private:
     uint8_t
       _dialPin ;
 
     void
-      _update( void ) ;
+      _update( void ) ,
+      _filter( uint16_t reading ) ,
+      _release( void ) ;
+
+    static bool
+      _inBand( uint8_t mode, int reading, int margin ) ;
 
     runmode_e
       _mode ;
 
+    StuSpsc< uint16_t, DIAL_QUEUE_SIZE >
+      _queue ;
+
+    uint16_t
+      _samples[ DIAL_MEDIAN_SAMPLES ] ;
+
+    uint8_t
+      _sampleItr ,
+      _candidate ,
+      _debounce ,
+      _decimate ;
+
+    volatile uint8_t
+      _killCount ;
+
 };
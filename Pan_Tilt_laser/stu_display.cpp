@@ -9,140 +9,182 @@ Library to control leds displaying mode/power status
 
 @section  HISTORY
 v0.0.1 - First release
+v0.1.0 - Dirty tracking; LEDs sharing an AVR port are written with one
+         masked port write.
+v0.1.1 - LED pins come from panTilt_config.h at compile time (FastPin).
+v0.2.0 - Single Timer0 compare ISR drives all LEDs from pattern
+         descriptors (adds breathe); no scheduler timers, update() removed.
+v0.2.1 - Diagnostics go through the buffered logger (stu_log.h).
+v0.2.2 - begin() can skip the LED walk (warm boot).
 
 */
 /**************************************************************************/
 
 #include "stu_display.h"
+#include "stu_log.h"
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
 
 
-//#define DISPLAY_DEBUG
+// Default pattern for each ledState_e
+static const ledPattern_t defaultPatterns[ LED_STATE_COUNT ] PROGMEM = {
+  /* LED_OFF     */ { LED_OFF,     0, 0 },
+  /* LED_ON      */ { LED_ON,      0, 0 },
+  /* LED_BLINK   */ { LED_BLINK,   LED_DUTY( LED_BLINK_ON_TIME, LED_BLINK_PERIOD ), LED_STEP( LED_BLINK_PERIOD ) },
+  /* LED_BREATHE */ { LED_BREATHE, 0, LED_STEP( LED_BREATHE_PERIOD ) }
+};
 
-StuDisplay::StuDisplay( uint8_t contPin, uint8_t intPin, uint8_t sleepPin ):
-                    _sleep( sleepPin ), _continuous( contPin ),
-                    _intermittent( intPin ),_blinkTime(0){
+StuDisplay* StuDisplay::_instance = NULL;
 
 
-                      _led[ 0 ] = &_continuous ;
-                      _led[ 1 ] = &_intermittent ;
-                      _led[ 2 ] = &_sleep ;
+StuDisplay::StuDisplay( void ):_out( 0 ){
+
+  for( uint8_t i = 0; i < LED_NUMBER; i++ ){
+    _led[ i ].pattern.state = LED_OFF ;
+    _led[ i ].phase = 0 ;
+    _led[ i ].acc = 0 ;
+  }
 }
 
 
-void StuDisplay::begin( void ){
+void StuDisplay::begin( bool walk ){
 
+  FastPin< LED0_PIN >::output() ;
+  FastPin< LED1_PIN >::output() ;
+  FastPin< LED2_PIN >::output() ;
 
-  for(int i = 0; i < LED_NUMBER; i++){
-    scheduler.addEvent(&_led[ i ]->_blinkTimer);
-    pinMode( _led[ i ]->pin , OUTPUT ) ;
-    _ledWrite( _led[ i ], HIGH );
-    StuDisplay::update();
+  // Timer0 is already running for millis(); compare A in mid-count gives a
+  // second 976 Hz interrupt. Pin 6 (OC0A) is not used as PWM here.
+  _instance = this ;
+  OCR0A = 0x80 ;
+  TIMSK0 |= _BV( OCIE0A ) ;
+
+  if( !walk ){
+    return ;
+  }
 
+  for( uint8_t i = 0; i < LED_NUMBER; i++ ){
+    setLEDState( i, LED_ON );
     delay(450);
 
   }
 
-  for(int i = 0; i < LED_NUMBER; i++){
-    _ledWrite( _led[ i ], LOW );
+  for( uint8_t i = 0; i < LED_NUMBER; i++ ){
+    setLEDState( i, LED_OFF );
 
   }
-  StuDisplay::update();
 
   delay(1000);
 
 }
 
-void StuDisplay::update( void ){
-
-  for(int i = 0; i < LED_NUMBER; i++){
-    digitalWrite(_led[ i ]->pin, _led[ i ]->state ) ;
-
-    if(_led[ i ]->_blinkTimer.enabled()){
-      if(_led[ i ]->_blinkTimer.check()){
-        #ifdef SERIAL_DEBUG
-        #ifdef DISPLAY_DEBUG
-          MY_SERIAL.println(F("Blink Timer"));
-        #endif
-        #endif
-        _blinkLED( _led[ i ] );
-      }
-    }
-  }
-}
-
 
 void StuDisplay::setLEDStates( ledState_e e1, ledState_e e2, ledState_e e3 ){
 
-  setLEDState( &_continuous , e1 );
-  setLEDState( &_intermittent , e2 );
-  setLEDState( &_sleep , e3 );
+  setLEDState( 0, e1 );
+  setLEDState( 1, e2 );
+  setLEDState( 2, e3 );
 
 }
 
 void StuDisplay::setLEDState( uint8_t ledVal, ledState_e e ){
-    return setLEDState( _led[ledVal], e );
-
-}
+  ledPattern_t p ;
 
+  if( e >= LED_STATE_COUNT ){
+    e = LED_OFF ;
+  }
+  memcpy_P( &p, &defaultPatterns[ e ], sizeof( p ) ) ;
+  setLEDPattern( ledVal, p ) ;
 
+}
 
-void StuDisplay::setLEDState( led_t* l, ledState_e e ){
+// Restarts the pattern unless the LED already runs exactly this one, so
+// re-applying the same state doesn't reset a blink or breathe cycle.
+void StuDisplay::setLEDPattern( uint8_t ledVal, const ledPattern_t& p ){
 
-  _disableBlink(l);
+  if( ledVal >= LED_NUMBER ){
+    return ;
+  }
+  led_t* l = &_led[ ledVal ] ;
+
+  ATOMIC_BLOCK( ATOMIC_RESTORESTATE ){
+    if( l->pattern.state != p.state || l->pattern.duty != p.duty ||
+        l->pattern.step != p.step ){
+      l->pattern = p ;
+      l->phase = 0 ;
+      l->acc = 0 ;
+    }
+  }
 
-    switch( e ){
+  LOGV( DISPLAY, DEBUG, "LED slot, pattern (tens, ones): ", ledVal * 10 + p.state );
+}
 
-      case LED_OFF:
-        _ledWrite(l, LOW ) ;
-        break;
+// Advance one LED by a tick and return its pin state.
+bool StuDisplay::_ledOutput( led_t* l ){
 
-      case LED_ON:
-        _ledWrite(l, HIGH ) ;
-        break;
+  switch( l->pattern.state ){
 
-      case LED_BLINK:
-      _enableBlink(l, 35, 5000 ) ;
-        break;
+    case LED_ON:
+      return 1 ;
 
+    case LED_BLINK:
+      l->phase += l->pattern.step ;
+      return (uint8_t)~( l->phase >> 8 ) < l->pattern.duty ;
 
+    case LED_BREATHE:{
+      l->phase += l->pattern.step ;
+      uint8_t pos = l->phase >> 8 ;
+      uint8_t tri = ( pos & 0x80 ? 255 - pos : pos ) << 1 ; // 0..254..0
+      uint8_t level = ( (uint16_t)tri * tri ) >> 8 ;         // rough gamma
+      uint8_t prev = l->acc ;
+      l->acc += level ;
+      return l->acc < prev ;                                 // carry out
     }
 
+    default:
+      return 0 ;
   }
-
-
-void StuDisplay::_ledWrite( led_t* led, bool ledState ){
-
-  led->state = ledState ;
-
 }
 
-void StuDisplay::_enableBlink( led_t* led, unsigned int onTime, unsigned int offTime ){
-  _offTime = offTime ;
-  _blinkTime = onTime;
-  setLEDState(led, LED_OFF);
-  led->_blinkTimer.setInterval( _offTime ) ;
-  led->_blinkTimer.start();
-
-}
+void StuDisplay::_tick( void ){
+  uint8_t on = 0 ;
 
-void StuDisplay::_disableBlink( led_t* led ){
-  led->_blinkTimer.stop();
+  for( uint8_t i = 0; i < LED_NUMBER; i++ ){
+    if( _ledOutput( &_led[ i ] ) ){
+      on |= 1 << i ;
+    }
+  }
 
+  if( on != _out ){
+    _out = on ;
+    _flush( on ) ;
+  }
 }
 
-void StuDisplay::_blinkLED( led_t* led ){
-  static uint8_t intervalItr;
-  unsigned int* interval[2];
+// One read-modify-write per port; ports without LEDs compile away. Runs in
+// the ISR, so it can't be interrupted by the laser's port writes.
+void StuDisplay::_flush( uint8_t on ){
+  uint8_t bits[ 3 ] = { 0, 0, 0 };
 
-  interval[ 0 ] = &_offTime;
-  interval[ 1 ] = &_blinkTime;
-    _ledWrite(led, intervalItr) ;
-    StuDisplay::update() ;
+  if( on & 0x01 ) bits[ FastPin< LED0_PIN >::portId ] |= FastPin< LED0_PIN >::mask;
+  if( on & 0x02 ) bits[ FastPin< LED1_PIN >::portId ] |= FastPin< LED1_PIN >::mask;
+  if( on & 0x04 ) bits[ FastPin< LED2_PIN >::portId ] |= FastPin< LED2_PIN >::mask;
 
-    led->_blinkTimer.setInterval(*interval[intervalItr]);
+  if( LED_PORT_MASK( FASTPIN_PORT_B ) ){
+    PORTB = ( PORTB & ~LED_PORT_MASK( FASTPIN_PORT_B ) ) | bits[ FASTPIN_PORT_B ];
+  }
+  if( LED_PORT_MASK( FASTPIN_PORT_C ) ){
+    PORTC = ( PORTC & ~LED_PORT_MASK( FASTPIN_PORT_C ) ) | bits[ FASTPIN_PORT_C ];
+  }
+  if( LED_PORT_MASK( FASTPIN_PORT_D ) ){
+    PORTD = ( PORTD & ~LED_PORT_MASK( FASTPIN_PORT_D ) ) | bits[ FASTPIN_PORT_D ];
+  }
 
-    led->_blinkTimer.resetPeriodic();
+}
 
-    intervalItr ^= 1;
 
+ISR( TIMER0_COMPA_vect ){
+  if( StuDisplay::_instance ){
+    StuDisplay::_instance->_tick() ;
+  }
 }
@@ -6,9 +6,21 @@
 
 Library to control leds displaying mode/power status
 
+All LEDs are driven from one interrupt: Timer0 compare A, which fires once
+per Timer0 overflow period (1.024 ms) without touching millis(). Each LED
+has a small pattern descriptor (on/off/blink/breathe, duty and period) and
+a 16 bit phase accumulator; the ISR advances the phases, works out the new
+pin states and writes each port once, only when something changed. LED
+timing no longer depends on how often the main loop runs.
+
 
 @section  HISTORY
 v0.0.1 - First release
+v0.1.0 - Dirty tracking; LEDs sharing an AVR port are written with one
+         masked port write.
+v0.1.1 - LED pins come from panTilt_config.h at compile time (FastPin).
+v0.2.0 - Single Timer0 compare ISR drives all LEDs from pattern
+         descriptors (adds breathe); no scheduler timers, update() removed.
 
 */
 /**************************************************************************/
@@ -17,33 +29,66 @@ v0.0.1 - First release
 
 #include "Arduino.h"
 #include "panTilt_config.h"
-#include "stu_scheduler.h"
+#include "stu_fastpin.h"
 
 
 #define LED_NUMBER 3
 
+// Pin per LED slot (_led[ 0 ], _led[ 1 ], _led[ 2 ])
+#define LED0_PIN POWER_PIN
+#define LED1_PIN CONT_PIN
+#define LED2_PIN INT_PIN
+
+// Display bits owned on each port
+#define LED_PORT_MASK( id ) ( FastPin< LED0_PIN >::maskOn( id ) | \
+                              FastPin< LED1_PIN >::maskOn( id ) | \
+                              FastPin< LED2_PIN >::maskOn( id ) )
+
+#define LED_TICK_US 1024UL // Timer0 overflow period
+
+// Phase increment per tick for a pattern period in ms (full cycle == 65536)
+#define LED_STEP( ms ) ( (uint16_t)( 65536UL * LED_TICK_US / 1000UL / ( ms ) ) )
+
+// Blink on-time in 1/256 of the period
+#define LED_DUTY( onMs, periodMs ) ( (uint8_t)( ( 256UL * ( onMs ) + ( periodMs ) - 1 ) / ( periodMs ) ) )
+
+#define LED_BLINK_ON_TIME    35   // ms
+#define LED_BLINK_PERIOD     5035 // ms
+#define LED_BREATHE_PERIOD   3000 // ms
+
 
 typedef enum ledState_e{
   LED_OFF = 0,
   LED_ON     ,
   LED_BLINK  ,
+  LED_BREATHE,
+  LED_STATE_COUNT
 }ledState_e;
 
-typedef struct led_t{
+// Compact per-LED pattern. Blink is off for the first part of the period
+// and on for the last duty/256 of it; breathe ramps up and down once per
+// period.
+typedef struct ledPattern_t{
 
-  uint8_t const
-    pin ; // pin for the led
+  uint8_t
+    state ,   // ledState_e
+    duty ;    // blink on-time, 1/256 of the period
 
-  bool
-    state ; // current pin state (ON/OFF)
+  uint16_t
+    step ;    // phase increment per tick, LED_STEP( period )
 
-  Timer
-    _blinkTimer;
+}ledPattern_t;
 
-  led_t( uint8_t ledPin ): pin( ledPin ), state( 0 ), _blinkTimer(){
-    scheduler.addEvent(&_blinkTimer);
-    _blinkTimer.disable();
-  }
+typedef struct led_t{
+
+  ledPattern_t
+    pattern ;
+
+  uint16_t
+    phase ;
+
+  uint8_t
+    acc ;     // breathe: first order sigma-delta accumulator
 
 }led_t;
 
@@ -52,33 +97,32 @@ class StuDisplay{
 
 public:
 
-  StuDisplay( uint8_t pwrLED, uint8_t contLED, uint8_t intLED ) ;
+  StuDisplay( void ) ;
 
   void
-    begin( void ) ,
-    setLEDState( led_t* led, ledState_e e  ),
+    begin( bool walk = true ) , // walk: light each LED in turn (cold boot)
     setLEDState( uint8_t ledVal, ledState_e e ),
     setLEDStates( ledState_e e1, ledState_e e2, ledState_e e3 ),
-    update( void ) ;
+    setLEDPattern( uint8_t ledVal, const ledPattern_t& p ) ;
+
+  void
+    _tick( void ) ;             // Timer0 compare A (called from ISR)
+
+  static StuDisplay*
+    _instance ;
 
 private:
 
-  void
-    _ledWrite( led_t* led, bool ledState ) ,
-    _enableBlink( led_t* led, unsigned int duration, unsigned int onTime ) ,
-    _blinkLED( led_t* led ) ,
-    _disableBlink( led_t* led ) ;
+  static bool
+    _ledOutput( led_t* led ) ;
 
-  led_t* _led[ LED_NUMBER ] ;
+  static void
+    _flush( uint8_t on ) ;
 
   led_t
-    _sleep        ,
-    _continuous   ,
-    _intermittent ;
-
+    _led[ LED_NUMBER ] ;
 
-    unsigned int
-      _offTime,
-      _blinkTime  ;
+  uint8_t
+    _out ;                      // last written state, bit per LED
 
 };
@@ -0,0 +1,53 @@
+/**************************************************************************/
+/*!
+    @file     stu_eeprom.cpp
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    EEPROM layout and CRC-protected block storage. Every block is stored
+    as its raw bytes followed by a CRC16 so a torn or stale write is
+    detected on read.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+
+*/
+/**************************************************************************/
+
+#include "stu_eeprom.h"
+
+
+uint16_t crc16( const void* data, uint16_t len ){
+  const uint8_t* p = (const uint8_t*)data ;
+  uint16_t crc = 0xFFFF ;
+
+  while( len-- ){
+    crc = _crc16_update( crc, *p++ ) ;
+  }
+  return crc ;
+}
+
+bool eepromReadBlock( int addr, void* data, uint16_t len ){
+  uint8_t* p = (uint8_t*)data ;
+
+  for( uint16_t i = 0; i < len; i++ ){
+    p[ i ] = EEPROM.read( addr + i ) ;
+  }
+
+  uint16_t stored = EEPROM.read( addr + len ) | ( EEPROM.read( addr + len + 1 ) << 8 ) ;
+  return stored == crc16( data, len ) ;
+}
+
+// EEPROM.update() skips unchanged bytes, which saves write cycles when the
+// same block is saved repeatedly.
+void eepromWriteBlock( int addr, const void* data, uint16_t len ){
+  const uint8_t* p = (const uint8_t*)data ;
+  uint16_t crc = crc16( data, len ) ;
+
+  for( uint16_t i = 0; i < len; i++ ){
+    EEPROM.update( addr + i, p[ i ] ) ;
+  }
+  EEPROM.update( addr + len, crc & 0xFF ) ;
+  EEPROM.update( addr + len + 1, crc >> 8 ) ;
+}
@@ -0,0 +1,43 @@
+/**************************************************************************/
+/*!
+    @file     stu_eeprom.h
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    EEPROM layout and CRC-protected block storage. Every block is stored
+    as its raw bytes followed by a CRC16 so a torn or stale write is
+    detected on read.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+    v0.0.2 - Warm boot record block.
+    v0.0.3 - Trajectory recording header and ring.
+
+*/
+/**************************************************************************/
+#pragma once
+
+#include "Arduino.h"
+#include <EEPROM.h>
+#include <util/crc16.h>
+
+// EEPROM layout (ATmega328: 1024 bytes). Each block reserves 2 CRC bytes.
+#define EEPROM_PARAMS_ADDR    0    // motionParams_t (stu_params.h)
+#define EEPROM_PARAMS_SIZE    64
+#define EEPROM_BOOT_ADDR      64   // bootRecord_t (stu_boot.h)
+#define EEPROM_BOOT_SIZE      16
+#define EEPROM_REC_HDR_ADDR   80   // recordHeader_t (stu_record.h)
+#define EEPROM_REC_HDR_SIZE   16
+#define EEPROM_REC_ADDR       128  // recording ring, raw bytes (no CRC)
+#define EEPROM_REC_SIZE       896
+
+
+uint16_t
+  crc16( const void* data, uint16_t len ) ;
+
+bool
+  eepromReadBlock( int addr, void* data, uint16_t len ) ;  // false on CRC mismatch
+
+void
+  eepromWriteBlock( int addr, const void* data, uint16_t len ) ;
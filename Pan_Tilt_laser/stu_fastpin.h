@@ -0,0 +1,90 @@
+/**************************************************************************/
+/*!
+    @file     stu_fastpin.h
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Compile-time GPIO for the ATmega328 (Arduino Uno pin numbering). The
+    pin is a template parameter, so port and bit resolve at compile time
+    and high()/low() compile to single sbi/cbi instructions instead of
+    digitalWrite()'s pin table lookups. Nothing is stored in RAM.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+
+*/
+/**************************************************************************/
+#pragma once
+
+#include "Arduino.h"
+
+// Port ids used by FastPin<>::portId
+#define FASTPIN_PORT_B 0
+#define FASTPIN_PORT_C 1
+#define FASTPIN_PORT_D 2
+
+
+template< uint8_t PIN >
+struct FastPin {
+
+  static_assert( PIN < 20, "FastPin: ATmega328 digital pins 0-13 and A0-A5 only" );
+
+  static const uint8_t
+    portId = PIN < 8 ? FASTPIN_PORT_D : PIN < 14 ? FASTPIN_PORT_B : FASTPIN_PORT_C ,
+    mask = 1 << ( PIN < 8 ? PIN : PIN < 14 ? PIN - 8 : PIN - 14 ) ;
+
+  // mask if this pin lives on port id, else 0 (for building port masks)
+  static constexpr uint8_t maskOn( uint8_t id ){
+    return portId == id ? mask : 0 ;
+  }
+
+  static inline volatile uint8_t& port( void ){
+    return PIN < 8 ? PORTD : PIN < 14 ? PORTB : PORTC ;
+  }
+
+  static inline volatile uint8_t& ddr( void ){
+    return PIN < 8 ? DDRD : PIN < 14 ? DDRB : DDRC ;
+  }
+
+  static inline volatile uint8_t& in( void ){
+    return PIN < 8 ? PIND : PIN < 14 ? PINB : PINC ;
+  }
+
+  static inline void output( void ){
+    ddr() |= mask ;
+  }
+
+  static inline void input( void ){
+    ddr() &= ~mask ;
+  }
+
+  static inline void high( void ){
+    port() |= mask ;
+  }
+
+  static inline void low( void ){
+    port() &= ~mask ;
+  }
+
+  static inline void write( bool state ){
+    if( state ){
+      high() ;
+    }
+    else{
+      low() ;
+    }
+  }
+
+  static inline void toggle( void ){
+    in() = mask ; // writing 1 to PINx toggles PORTx
+  }
+
+  static inline bool read( void ){
+    return in() & mask ;
+  }
+
+};
+
+template< uint8_t PIN > const uint8_t FastPin< PIN >::portId;
+template< uint8_t PIN > const uint8_t FastPin< PIN >::mask;
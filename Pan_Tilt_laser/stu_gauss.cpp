@@ -4,35 +4,110 @@
     @author   Stuart Feichtinger
     @license  MIT (see license.txt)
 
-    Wrapper library for Gaussian library
-    (https://github.com/ivanseidel/Gaussian) to create random number
-    generator with custom distribution.
+    Integer normal random number generator with custom mean/variance.
+    Uses a 64 bin inverse-CDF table of the half-normal distribution in
+    PROGMEM with linear interpolation, so no floating point is linked in.
 
 
     @section  HISTORY
     v0.0.1 - First release
+    v0.1.0 - Replaced Gaussian library (double) with fixed-point inverse CDF.
+    v0.1.1 - Tail bin interpolation no longer overflows a 16 bit int.
 
 */
 /**************************************************************************/
 
 #include "stu_gauss.h"
+#include "stu_log.h"
+
+
+// InverseNormalCDF(0.5 + 0.5 * i / 64) * 256 for i = 0..63. The last entry
+// closes the tail bin so its mean matches E[Z | Z > 2.418] (~2.74).
+static const uint16_t zTable[ 65 ] PROGMEM = {
+    0,   5,  10,  15,  20,  25,  30,  35,  40,  45,  50,
+   56,  61,  66,  71,  76,  82,  87,  92,  98, 103, 108,
+  114, 120, 125, 131, 137, 142, 148, 154, 160, 166, 173,
+  179, 185, 192, 199, 206, 213, 220, 227, 235, 242, 250,
+  259, 267, 276, 285, 294, 304, 315, 326, 337, 350, 363,
+  377, 393, 410, 429, 451, 477, 509, 551, 619, 783
+};
 
 
 StuGauss gauss;
 
-StuGauss::StuGauss():_gauss(){
+StuGauss::StuGauss():_variance( 0 ), _sigmaQ4( 0 ){
 
 
 }
 
-unsigned long StuGauss::gRandom(unsigned long zero, double variance){
-  _gauss.setVariance(variance);
-  _gauss.setMean(zero);
-  double temp = _gauss.random();
+// 16 random bits: sign (1), bin (6), interpolation fraction (8).
+int StuGauss::standardQ8( void ){
+  uint16_t r = rng.next() >> 16 ;
+  uint8_t idx = ( r >> 9 ) & 0x3F ;
+  uint8_t frac = r >> 1 ;
 
-  #ifdef GAUSS_DEBUG
-    MY_SERIAL.println(temp);
-  #endif
+  int a = pgm_read_word( &zTable[ idx ] ) ;
+  int b = pgm_read_word( &zTable[ idx + 1 ] ) ;
+  // Unsigned: the last bin is 164 wide and 164 * 255 overflows a 16 bit int.
+  int z = a + (int)( ( (uint16_t)( b - a ) * frac ) >> 8 ) ;
 
-  return round(max(temp, 2));
+  return ( r & 0x8000 ) ? -z : z ;
 }
+
+unsigned long StuGauss::gRandom( unsigned long zero, unsigned int variance ){
+
+  if( variance != _variance ){ // sqrt only when the caller changes variance
+    _variance = variance ;
+    _sigmaQ4 = _isqrt( (uint32_t)variance << 8 ) ;
+  }
+
+  // z (Q8) * sigma (Q4) => Q12, rounded to whole units
+  long offset = (long)standardQ8() * _sigmaQ4 ;
+  long temp = (long)zero + ( ( offset + 2048 ) >> 12 ) ;
+
+  LOGV( GAUSS, DEBUG, "gRandom: ", temp );
+
+  return max(temp, 2);
+}
+
+uint16_t StuGauss::_isqrt( uint32_t v ){
+  uint32_t res = 0 ;
+  uint32_t bit = 1UL << 30 ;
+
+  while( bit > v ){
+    bit >>= 2 ;
+  }
+
+  while( bit ){
+    if( v >= res + bit ){
+      v -= res + bit ;
+      res = ( res >> 1 ) + bit ;
+    }
+    else{
+      res >>= 1 ;
+    }
+    bit >>= 2 ;
+  }
+  return res ;
+}
+
+
+#if defined( SERIAL_DEBUG ) && defined( GAUSS_BENCHMARK )
+
+#define GAUSS_BENCH_LOOPS 1000
+
+void gaussBenchmark( void ){
+  volatile long sink = 0 ;
+  unsigned long t0 = micros() ;
+
+  for( int i = 0; i < GAUSS_BENCH_LOOPS; i++ ){
+    sink += gauss.gRandom( 15, 6 ) ;
+  }
+  unsigned long t = micros() - t0 ;
+
+  MY_SERIAL.print(F("gRandom() cycles/sample: "));
+  MY_SERIAL.println( t * ( F_CPU / 1000000UL ) / GAUSS_BENCH_LOOPS ) ;
+
+}
+
+#endif
@@ -1,25 +1,29 @@
-
 /**************************************************************************/
 /*!
     @file     stu_gauss.h
     @author   Stuart Feichtinger
     @license  MIT (see license.txt)
 
-    Wrapper library for Gaussian library
-    (https://github.com/ivanseidel/Gaussian) to create random number
-    generator with custom distribution.
+    Integer normal random number generator with custom mean/variance.
+    Uses a 64 bin inverse-CDF table of the half-normal distribution in
+    PROGMEM with linear interpolation, so no floating point is linked in.
 
 
     @section  HISTORY
     v0.0.1 - First release
+    v0.1.0 - Replaced Gaussian library (double) with fixed-point inverse CDF.
+    v0.1.1 - Tail bin interpolation no longer overflows a 16 bit int.
 
 */
 /**************************************************************************/
 #pragma once
 
 #include "Arduino.h"
-#include <Gaussian.h>
+#include <avr/pgmspace.h>
+#include "panTilt_config.h"
+#include "stu_random.h"
 
+//#define GAUSS_BENCHMARK // print cycles per sample at boot
 
 
 class StuGauss {
@@ -30,13 +34,26 @@ public:
 
 
   unsigned long
-    gRandom( unsigned long zero, double variance ) ;
+    gRandom( unsigned long zero, unsigned int variance ) ;
+
+  static int
+    standardQ8( void ) ;      // N(0, 1) sample scaled by 256
 
 private:
 
-        Gaussian
-          _gauss;
+  static uint16_t
+    _isqrt( uint32_t v ) ;
+
+  unsigned int
+    _variance ;
+
+  uint16_t
+    _sigmaQ4 ;                // sqrt(_variance) * 16
 
 };
 
 extern StuGauss gauss;
+
+#if defined( SERIAL_DEBUG ) && defined( GAUSS_BENCHMARK )
+void gaussBenchmark( void ) ;
+#endif
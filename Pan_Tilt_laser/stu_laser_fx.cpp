@@ -0,0 +1,183 @@
+/**************************************************************************/
+/*!
+    @file     stu_laser_fx.cpp
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Laser brightness and effects (flicker, strobe, fade in/out) driven
+    entirely by Timer2, so effects cost no main-loop time.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+    v0.0.2 - Output is gated by the dial kill latch (StuDial::killed()).
+
+*/
+/**************************************************************************/
+
+#include "stu_laser_fx.h"
+#include "stu_dial.h"
+#include <util/atomic.h>
+
+#ifdef LASER_PWM
+
+// PWM duty for perceptual level >> 2, gamma 2.2
+static const uint8_t gammaTable[ 64 ] PROGMEM = {
+    0,   0,   0,   0,   1,   1,   1,   2,   3,   4,   4,   5,   7,   8,   9,  11,
+   13,  14,  16,  18,  20,  23,  25,  28,  31,  33,  36,  40,  43,  46,  50,  54,
+   57,  61,  66,  70,  74,  79,  84,  89,  94,  99, 105, 110, 116, 122, 128, 134,
+  140, 147, 153, 160, 167, 174, 182, 189, 197, 205, 213, 221, 229, 238, 246, 255
+};
+
+// Compare output (hardware PWM) is only available on Timer2's own pins.
+#define LASER_HW_PWM ( LASER_PIN == 11 )
+
+static volatile uint8_t laserDuty = 0 ;
+
+StuLaserFx laserFx;
+
+
+StuLaserFx::StuLaserFx( void ):_fx( LASER_FX_NONE ), _level( 0 ), _brightness( LASER_BRIGHTNESS ),
+  _divider( 0 ), _phase( 0 ), _noise( 0xA5 ){
+
+}
+
+// Timer2: fast PWM, TOP 0xFF, prescaler 64 -> 976 Hz, overflow ISR always
+// on (effect clock).
+void StuLaserFx::begin( void ){
+  FastPin< LASER_PIN >::low() ;
+  FastPin< LASER_PIN >::output() ;
+
+  TCCR2A = _BV( WGM21 ) | _BV( WGM20 ) ;
+  TCCR2B = _BV( CS22 ) ;
+  OCR2A = 0 ;
+  TIMSK2 = _BV( TOIE2 ) ;
+
+}
+
+void StuLaserFx::setBrightness( uint8_t level ){
+  _brightness = level ;
+
+}
+
+void StuLaserFx::fire( bool state ){
+  _fx = LASER_FX_NONE ;
+  _setLevel( state ? _brightness : 0 ) ;
+
+}
+
+void StuLaserFx::play( laserFx_e fx ){
+  _phase = 0 ;
+  _divider = 0 ;
+  if( fx == LASER_FX_FADE_IN ){
+    _setLevel( 0 ) ;
+  }
+  _fx = fx ;
+
+}
+
+bool StuLaserFx::busy( void ) const {
+  return _fx == LASER_FX_FADE_IN || _fx == LASER_FX_FADE_OUT ;
+}
+
+// The dial ISR may cut the laser at any time (StuDial::killed()), so the
+// check and the output change happen with interrupts off.
+void StuLaserFx::_setLevel( uint8_t level ){
+  uint8_t duty = pgm_read_byte( &gammaTable[ level >> 2 ] ) ;
+
+  _level = level ;
+
+  ATOMIC_BLOCK( ATOMIC_RESTORESTATE ){
+    laserDuty = duty ;
+    if( StuDial::killed() ){
+      duty = 0 ;
+    }
+
+#if LASER_HW_PWM
+    OCR2A = duty ;
+    if( duty ){
+      TCCR2A |= _BV( COM2A1 ) ;
+    }
+    else{
+      TCCR2A &= ~_BV( COM2A1 ) ;
+      FastPin< LASER_PIN >::low() ;
+    }
+#else
+    OCR2A = duty ;
+    if( duty && duty != 0xFF ){
+      TIMSK2 |= _BV( OCIE2A ) ;
+    }
+    else{
+      TIMSK2 &= ~_BV( OCIE2A ) ;
+      FastPin< LASER_PIN >::write( duty ) ;
+    }
+#endif
+  }
+}
+
+// Effect clock, every LASER_FX_DIVIDER overflows.
+void StuLaserFx::_tick( void ){
+
+  if( ++_divider < LASER_FX_DIVIDER ){
+    return ;
+  }
+  _divider = 0 ;
+
+  switch( _fx ){
+
+    case LASER_FX_FLICKER:
+      _noise ^= _noise << 3 ;           // 8 bit xorshift, never reaches 0
+      _noise ^= _noise >> 5 ;
+      _noise ^= _noise << 1 ;
+      _setLevel( _brightness - ( ( _brightness >> 2 ) & _noise ) ) ;
+      break;
+
+    case LASER_FX_STROBE:
+      if( ++_phase >= LASER_STROBE_STEPS ){
+        _phase = 0 ;
+        _setLevel( _level ? 0 : _brightness ) ;
+      }
+      break;
+
+    case LASER_FX_FADE_IN:
+      if( ++_phase >= LASER_FADE_STEPS ){
+        _setLevel( _brightness ) ;
+        _fx = LASER_FX_NONE ;
+      }
+      else{
+        _setLevel( ( (uint16_t)_brightness * _phase ) / LASER_FADE_STEPS ) ;
+      }
+      break;
+
+    case LASER_FX_FADE_OUT:
+      if( ++_phase >= LASER_FADE_STEPS || !_level ){
+        _setLevel( 0 ) ;
+        _fx = LASER_FX_NONE ;
+      }
+      else{
+        _setLevel( ( (uint16_t)_brightness * ( LASER_FADE_STEPS - _phase ) ) / LASER_FADE_STEPS ) ;
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+
+ISR( TIMER2_OVF_vect ){
+#if !LASER_HW_PWM
+  if( laserDuty && !StuDial::killed() ){
+    FastPin< LASER_PIN >::high() ;
+  }
+#endif
+  laserFx._tick() ;
+}
+
+#if !LASER_HW_PWM
+ISR( TIMER2_COMPA_vect ){
+  FastPin< LASER_PIN >::low() ;
+}
+#endif
+
+#endif // LASER_PWM
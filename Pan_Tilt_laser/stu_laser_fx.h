@@ -0,0 +1,77 @@
+/**************************************************************************/
+/*!
+    @file     stu_laser_fx.h
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Laser brightness and effects (flicker, strobe, fade in/out) driven
+    entirely by Timer2, so effects cost no main-loop time.
+
+    LASER_PIN (9) is OC1A, but Timer1 belongs to the Servo library, so
+    hardware PWM on pin 9 is not available. Timer2 runs in fast PWM mode
+    (976 Hz): the overflow ISR turns the laser on and the compare-A ISR
+    turns it off, which is PWM from two tiny ISRs. If the laser is rewired
+    to pin 11 (OC2A) the compare output drives it in hardware instead.
+
+    Levels are perceptual (0-255) and gamma corrected from a PROGMEM table.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+
+*/
+/**************************************************************************/
+#pragma once
+
+#include "Arduino.h"
+#include <avr/pgmspace.h>
+#include "panTilt_config.h"
+#include "stu_fastpin.h"
+
+#define LASER_FX_DIVIDER   8    // overflow ticks per effect step (~122 Hz)
+#define LASER_FADE_STEPS   64   // effect steps for a full fade (~0.5 s)
+#define LASER_STROBE_STEPS 6    // effect steps per strobe half-period
+
+typedef enum laserFx_e{
+  LASER_FX_NONE = 0 ,  // steady at the current level
+  LASER_FX_FLICKER  ,  // random brightness jitter around the brightness
+  LASER_FX_STROBE   ,  // on/off at LASER_STROBE_STEPS
+  LASER_FX_FADE_IN  ,  // 0 -> brightness, then steady
+  LASER_FX_FADE_OUT    // brightness -> 0, then off
+}laserFx_e;
+
+
+class StuLaserFx {
+
+public:
+
+  StuLaserFx( void ) ;
+
+  void
+    begin( void ) ,
+    setBrightness( uint8_t level ) ,
+    fire( bool state ) ,
+    play( laserFx_e fx ) ;
+
+  bool
+    busy( void ) const ;
+
+  void
+    _tick( void ) ;             // Timer2 overflow (ISR context)
+
+private:
+
+  void
+    _setLevel( uint8_t level ) ;
+
+  volatile uint8_t
+    _fx ,
+    _level ,                    // current perceptual level
+    _brightness ,               // level used when on
+    _divider ,
+    _phase ,
+    _noise ;
+
+};
+
+extern StuLaserFx laserFx;
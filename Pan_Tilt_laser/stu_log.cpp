@@ -0,0 +1,118 @@
+/**************************************************************************/
+/*!
+    @file     stu_log.cpp
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Buffered logging with compile-time per-module levels.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+
+*/
+/**************************************************************************/
+
+#include "stu_log.h"
+
+#ifdef SERIAL_DEBUG
+
+#include <avr/pgmspace.h>
+#include "stu_spsc.h"
+
+#ifndef SERIAL_TX_BUFFER_SIZE
+  #define SERIAL_TX_BUFFER_SIZE 64
+#endif
+
+typedef struct logEntry_t{
+
+  const char*
+    msg ;       // PROGMEM
+
+  int32_t
+    value ;
+
+  uint8_t
+    flags ;
+
+}logEntry_t;
+
+static StuSpsc< logEntry_t, LOG_QUEUE_SIZE > logQueue ;
+
+static const char levelTag[] PROGMEM = "?EWID" ;
+
+
+void logWrite( const char* msg, int32_t value, uint8_t flags ){
+  logEntry_t e ;
+
+  e.msg = msg ;
+  e.value = value ;
+  e.flags = flags ;
+  logQueue.push( e ) ;
+
+}
+
+// Worst-case bytes for one printed entry: tag, message, value, CRLF.
+static uint8_t entrySize( const logEntry_t& e ){
+  return 2 + strlen_P( e.msg ) + ( e.flags & LOG_HAS_VALUE ? 11 : 0 ) + 2 ;
+}
+
+static void printEntry( const logEntry_t& e ){
+  MY_SERIAL.write( pgm_read_byte( &levelTag[ e.flags & 0x07 ] ) ) ;
+  MY_SERIAL.write( ' ' ) ;
+  MY_SERIAL.print( (const __FlashStringHelper*)e.msg ) ;
+  if( e.flags & LOG_HAS_VALUE ){
+    MY_SERIAL.print( e.value ) ;
+  }
+  MY_SERIAL.println() ;
+
+}
+
+static logEntry_t pending ;
+static bool havePending = false ;
+
+// Print at most one entry, and only if it fits in the TX buffer (or the
+// buffer is empty, for entries longer than the whole buffer).
+static bool drainOne( void ){
+  int room = MY_SERIAL.availableForWrite() ;
+
+  if( !havePending ){
+    havePending = logQueue.pop( pending ) ;
+  }
+  if( !havePending ){
+    // Only take the count when the line fits, or it would be lost.
+    if( room >= 24 ){
+      uint8_t dropped = logQueue.takeDropped() ;
+      if( dropped ){
+        MY_SERIAL.print( F( "W log dropped " ) ) ;
+        MY_SERIAL.println( dropped ) ;
+      }
+    }
+    return false ;
+  }
+  if( room < entrySize( pending ) && room < SERIAL_TX_BUFFER_SIZE - 1 ){
+    return false ;
+  }
+  printEntry( pending ) ;
+  havePending = false ;
+  return true ;
+}
+
+void logIdle( uint16_t ms ){
+  uint32_t start = millis() ;
+
+  do{
+    drainOne() ;
+  }while( millis() - start < ms ) ;
+
+}
+
+// Blocking; for setup() only.
+void logFlush( void ){
+  do{
+    drainOne() ;
+  }while( havePending || !logQueue.empty() ) ;
+
+}
+
+#endif // SERIAL_DEBUG
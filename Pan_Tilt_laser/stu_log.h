@@ -0,0 +1,68 @@
+/**************************************************************************/
+/*!
+    @file     stu_log.h
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Buffered logging with compile-time per-module levels.
+
+      LOG( PANTILT, INFO, "MODE set to OFF" );
+      LOGV( DIAL, DEBUG, "Reading: ", adcReading );
+
+    A call whose level is above LOG_LEVEL_<module> (panTilt_config.h) is a
+    constant-false branch and compiles to nothing. An enabled call only
+    queues a flash string pointer and a value in a RAM ring buffer (no
+    formatting, no serial I/O); when the buffer is full the entry is dropped
+    and counted. The buffer is printed from LOG_IDLE( ms ), which replaces
+    the idle delay() at the end of loop() and only writes what fits in the
+    serial TX buffer, so logging never stalls the control path.
+
+    Without SERIAL_DEBUG every LOG/LOGV compiles out and LOG_IDLE is delay().
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+
+*/
+/**************************************************************************/
+#pragma once
+
+#include "Arduino.h"
+#include "panTilt_config.h"
+
+#define LOG_NONE  0
+#define LOG_ERROR 1
+#define LOG_WARN  2
+#define LOG_INFO  3
+#define LOG_DEBUG 4
+
+#define LOG_QUEUE_SIZE 16 // entries, power of two
+
+
+#ifdef SERIAL_DEBUG
+
+void
+  logWrite( const char* msg, int32_t value, uint8_t flags ) ,
+  logIdle( uint16_t ms ) ,
+  logFlush( void ) ;
+
+// logWrite() flags: level in bits 0-2, value present in bit 3
+#define LOG_HAS_VALUE 0x08
+
+  #define LOG( mod, lvl, msg ) \
+    do{ if( LOG_LEVEL_##mod >= LOG_##lvl ) logWrite( PSTR( msg ), 0, LOG_##lvl ) ; }while( 0 )
+
+  #define LOGV( mod, lvl, msg, v ) \
+    do{ if( LOG_LEVEL_##mod >= LOG_##lvl ) logWrite( PSTR( msg ), (int32_t)( v ), LOG_##lvl | LOG_HAS_VALUE ) ; }while( 0 )
+
+  #define LOG_IDLE( ms ) logIdle( ms )
+  #define LOG_FLUSH()    logFlush()
+
+#else
+
+  #define LOG( mod, lvl, msg )      do{ }while( 0 )
+  #define LOGV( mod, lvl, msg, v )  do{ }while( 0 )
+  #define LOG_IDLE( ms )            delay( ms )
+  #define LOG_FLUSH()               do{ }while( 0 )
+
+#endif
@@ -0,0 +1,53 @@
+/**************************************************************************/
+/*!
+    @file     stu_markov_models.h
+    @license  MIT (see license.txt)
+
+    GENERATED by Extra/Tools/markov_gen.py from markov_models.txt.
+    Do not edit; change the model file and regenerate.
+
+    Transition models used by the sketch, as PROGMEM alias tables for
+    AliasMarkov. Each row is one current state; entries are
+    { threshold, alias } per column.
+
+    Include from the sketch only (tables are defined here).
+*/
+/**************************************************************************/
+#pragma once
+
+#include "stuMarkov.h"
+
+
+// speed: 3 states, values 1 2 3
+//   0 ->  65.3%   34.7%    0.0%
+//   1 ->  24.8%   40.6%   34.7%
+//   2 ->  24.8%   34.7%   40.6%
+static const aliasEntry_t speedTable[ 3 * 3 ] PROGMEM = {
+  { 255, 0 }, {  10, 0 }, {   0, 1 },
+  { 190, 2 }, { 255, 1 }, { 200, 1 },
+  { 190, 2 }, { 255, 1 }, { 246, 1 }
+};
+static const uint8_t speedValues[ 3 ] PROGMEM = { 1, 2, 3 };
+static const aliasModel_t speedModel PROGMEM = { 3, speedTable, speedValues };
+
+// shake: 2 states, values 1 2
+//   0 ->  98.0%    2.0%
+//   1 ->  39.6%   60.4%
+static const aliasEntry_t shakeTable[ 2 * 2 ] PROGMEM = {
+  { 255, 0 }, {  10, 0 },
+  { 203, 1 }, { 255, 1 }
+};
+static const uint8_t shakeValues[ 2 ] PROGMEM = { 1, 2 };
+static const aliasModel_t shakeModel PROGMEM = { 2, shakeTable, shakeValues };
+
+// pause: 3 states, values 0 1 2
+//   0 ->  10.0%   65.0%   25.0%
+//   1 ->  10.0%   65.0%   25.0%
+//   2 ->  10.0%   65.0%   25.0%
+static const aliasEntry_t pauseTable[ 3 * 3 ] PROGMEM = {
+  {  77, 1 }, { 255, 1 }, { 192, 1 },
+  {  77, 1 }, { 255, 1 }, { 192, 1 },
+  {  77, 1 }, { 255, 1 }, { 192, 1 }
+};
+static const uint8_t pauseValues[ 3 ] PROGMEM = { 0, 1, 2 };
+static const aliasModel_t pauseModel PROGMEM = { 3, pauseTable, pauseValues };
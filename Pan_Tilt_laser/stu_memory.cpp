@@ -0,0 +1,78 @@
+/**************************************************************************/
+/*!
+    @file     stu_memory.cpp
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    RAM monitor: stack painting, free RAM and high-water mark.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+
+*/
+/**************************************************************************/
+
+#include "stu_memory.h"
+
+#ifdef MEMORY_MONITOR
+
+// Linker symbols (avr-libc)
+extern uint8_t __data_start, __data_end, __bss_start, __bss_end ;
+extern uint8_t _end, __stack, __heap_start ;
+extern char* __brkval ;
+
+void memPaint( void ) __attribute__(( naked, used, section( ".init1" ) )) ;
+
+// Runs before .init2 has cleared r1 or set up the stack, so no C: paint
+// _end .. __stack (RAMEND) with the canary from registers only.
+void memPaint( void ){
+  __asm__ __volatile__(
+    "    ldi r30, lo8(_end)     \n"
+    "    ldi r31, hi8(_end)     \n"
+    "    ldi r24, %0            \n"
+    "    ldi r25, hi8(__stack)  \n"
+    "    rjmp 2f                \n"
+    "1:  st Z+, r24             \n"
+    "2:  cpi r30, lo8(__stack)  \n"
+    "    cpc r31, r25           \n"
+    "    brlo 1b                \n"
+    "    breq 1b                \n"
+    :: "M" ( MEM_CANARY ) ) ;
+}
+
+static uint8_t* heapTop( void ){
+  return __brkval ? (uint8_t*)__brkval : &__heap_start ;
+}
+
+uint16_t memFree( void ){
+  uint8_t top ;   // lives at the current stack pointer
+  return &top - heapTop() ;
+}
+
+// Canary bytes above the heap that nothing has written since reset. The
+// heap grows up through the painted area too, so scanning starts at its
+// current top.
+uint16_t memStackHighWater( void ){
+  const uint8_t* p = heapTop() ;
+  uint16_t n = 0 ;
+
+  while( p <= &__stack && *p == MEM_CANARY ){
+    p++ ;
+    n++ ;
+  }
+  return n ;
+}
+
+void memReport( memoryReport_t* r ){
+  r->ramSize = RAMEND + 1 - RAMSTART ;
+  r->dataSize = &__data_end - &__data_start ;
+  r->bssSize = &_end - &__bss_start ;
+  r->heapSize = heapTop() - &__heap_start ;
+  r->freeNow = memFree() ;
+  r->freeMin = memStackHighWater() ;
+  r->stackMax = &__stack - heapTop() + 1 - r->freeMin ;
+
+}
+
+#endif // MEMORY_MONITOR
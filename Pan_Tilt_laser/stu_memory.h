@@ -0,0 +1,57 @@
+/**************************************************************************/
+/*!
+    @file     stu_memory.h
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    RAM monitor for the 2 KB ATmega328. Before any C runtime setup (.init1)
+    all RAM between the end of .bss/.noinit and the top of the stack is
+    painted with MEM_CANARY. Later the untouched canary bytes show how close
+    the stack has ever come to the heap (high-water mark), alongside the
+    current free RAM and the linker's .data/.bss sizes.
+
+    The report is read with the PARAM_CMD_MEMORY serial command
+    (stu_params.h, decoded by Extra/Tools/params_frame.py). The per-module
+    breakdown of static RAM and flash comes from the build itself:
+    Extra/Tools/ram_report.sh.
+
+    Enabled with MEMORY_MONITOR; otherwise nothing is compiled.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+
+*/
+/**************************************************************************/
+#pragma once
+
+#include "Arduino.h"
+#include "panTilt_config.h"
+
+#define MEM_CANARY 0xC5
+
+// Wire layout of the PARAM_CMD_MEMORY reply, all in bytes
+typedef struct memoryReport_t{
+
+  uint16_t
+    ramSize ,       // RAMEND + 1 - RAMSTART
+    dataSize ,      // initialised globals (.data)
+    bssSize ,       // zeroed globals (.bss + .noinit)
+    heapSize ,      // malloc() arena in use
+    freeNow ,       // stack pointer to heap top, right now
+    freeMin ,       // never-touched canary bytes: the high-water mark
+    stackMax ;      // deepest stack seen, from RAMEND
+
+}memoryReport_t;
+
+
+#ifdef MEMORY_MONITOR
+
+uint16_t
+  memFree( void ) ,
+  memStackHighWater( void ) ;
+
+void
+  memReport( memoryReport_t* r ) ;
+
+#endif
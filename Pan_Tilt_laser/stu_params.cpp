@@ -0,0 +1,322 @@
+/**************************************************************************/
+/*!
+    @file     stu_params.cpp
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Live-tunable motion parameters. A compact binary serial protocol stages
+    a new parameter block, which is swapped in atomically at the next
+    control-period boundary (apply()) without stopping motion. The active
+    block can be persisted to EEPROM with a CRC and is reloaded at boot.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+    v0.0.2 - PARAM_CMD_PROFILE dumps and clears the loop profiler table.
+    v0.0.3 - PARAM_CMD_MEMORY reports free RAM and the stack high-water mark.
+    v0.0.4 - PARAM_CMD_RECALIBRATE forces a cold boot (calibration sweep).
+    v0.0.5 - PARAM_CMD_RECORD, _PLAY and _STOP drive the trajectory recorder.
+
+*/
+/**************************************************************************/
+
+#include "stu_params.h"
+
+StuParams params;
+
+typedef enum {
+  RX_SYNC = 0 ,
+  RX_CMD      ,
+  RX_LEN      ,
+  RX_PAYLOAD  ,
+  RX_CRC
+}rxState_e;
+
+
+StuParams::StuParams( void ):_active( 0 ), _rxState( RX_SYNC ), _staged( 0 ), _pending( 0 ), _callback( NULL ){
+  setDefaults( &_block[ 0 ] ) ;
+
+}
+
+void StuParams::setDefaults( motionParams_t* p ){
+  memset( p, 0, sizeof( motionParams_t ) ) ;
+  p->version = PARAMS_VERSION ;
+  p->dirChangeProb = DIRECTION_CHANGE_PROBABILITY ;
+  p->pauseMean = 15 ;
+  p->pauseVariance = 6 ;
+  p->minX = SERVO_MIN_X_AXIS ;
+  p->maxX = SERVO_MAX_X_AXIS ;
+  p->minY = SERVO_MIN_Y_AXIS ;
+  p->maxY = SERVO_MAX_Y_AXIS ;
+
+}
+
+// An n x n alias table is usable when every alias names a state and every
+// row keeps at least one column (an all-zero row would pin the chain to its
+// aliases, e.g. a zero-filled table to state 0).
+static bool tableValid( const aliasEntry_t* t, uint8_t n ){
+
+  for( uint8_t row = 0; row < n; row++ ){
+    uint8_t kept = 0 ;
+
+    for( uint8_t col = 0; col < n; col++, t++ ){
+      if( t->alias >= n ){
+        return false ;
+      }
+      kept |= t->threshold ;
+    }
+    if( !kept ){
+      return false ;
+    }
+  }
+  return true ;
+}
+
+bool StuParams::isValid( const motionParams_t* p ){
+
+  if( p->version != PARAMS_VERSION ){
+    return false ;
+  }
+
+  if( p->minX < SERVO_MIN_X_AXIS || p->maxX > SERVO_MAX_X_AXIS || p->minX >= p->maxX ||
+      p->minY < SERVO_MIN_Y_AXIS || p->maxY > SERVO_MAX_Y_AXIS || p->minY >= p->maxY ){
+    return false ;
+  }
+
+  if( ( p->flags & PARAM_FLAG_SPEED ) && !tableValid( p->speed, PARAM_SPEED_STATES ) ){
+    return false ;
+  }
+
+  if( ( p->flags & PARAM_FLAG_SHAKE ) && !tableValid( p->shake, PARAM_SHAKE_STATES ) ){
+    return false ;
+  }
+
+  return true ;
+}
+
+// Boot: take the EEPROM block if it is intact and valid for this build.
+void StuParams::begin( void ){
+  motionParams_t* p = &_block[ _active ^ 1 ] ;
+
+  if( eepromReadBlock( EEPROM_PARAMS_ADDR, p, sizeof( motionParams_t ) ) && isValid( p ) ){
+    _active ^= 1 ;
+  }
+  _staged = 0 ;
+  _pending = 0 ;
+
+  if( _callback ){
+    _callback() ;
+  }
+
+}
+
+void StuParams::setApplyCallback( Callback f ){
+  _callback = f ;
+
+}
+
+const motionParams_t& StuParams::get( void ) const {
+  return _block[ _active ] ;
+}
+
+// Called once per control period. Only here does the live block change, so
+// everything inside one loop() pass sees a single consistent block.
+void StuParams::apply( void ){
+
+  if( !_pending ){
+    return ;
+  }
+
+  _active ^= 1 ;
+  _pending = 0 ;
+  _staged = 0 ;
+
+  if( _callback ){
+    _callback() ;
+  }
+
+  _reply( PARAM_CMD_COMMIT, PARAM_OK ) ;
+
+}
+
+// Non-blocking: consumes whatever is in the serial buffer. Staged payload
+// bytes go straight into the inactive block. Parsing stops while a swap is
+// pending so the staged block can't be overwritten before apply().
+void StuParams::poll( void ){
+#ifdef PARAM_SERIAL
+
+  while( !_pending && MY_SERIAL.available() ){
+    uint8_t c = MY_SERIAL.read() ;
+
+    switch( _rxState ){
+
+      case RX_SYNC:
+        if( c == PARAM_SYNC ){
+          _rxState = RX_CMD ;
+        }
+        break;
+
+      case RX_CMD:
+        _rxCmd = c ;
+        _rxCrc = _crc8_ccitt_update( 0, c ) ;
+        _rxState = RX_LEN ;
+        break;
+
+      case RX_LEN:
+        _rxLen = c ;
+        _rxPos = 0 ;
+        _rxCrc = _crc8_ccitt_update( _rxCrc, c ) ;
+
+        if( _rxCmd == PARAM_CMD_STAGE ){
+          if( _rxLen != sizeof( motionParams_t ) ){
+            _reply( _rxCmd, PARAM_ERR_LENGTH ) ;
+            _rxState = RX_SYNC ;
+            break;
+          }
+          _staged = 0 ;
+          _rxState = RX_PAYLOAD ;
+        }
+        else if( _rxLen ){
+          _reply( _rxCmd, PARAM_ERR_LENGTH ) ;
+          _rxState = RX_SYNC ;
+        }
+        else{
+          _rxState = RX_CRC ;
+        }
+        break;
+
+      case RX_PAYLOAD:
+        ( (uint8_t*)&_block[ _active ^ 1 ] )[ _rxPos++ ] = c ;
+        _rxCrc = _crc8_ccitt_update( _rxCrc, c ) ;
+        if( _rxPos >= _rxLen ){
+          _rxState = RX_CRC ;
+        }
+        break;
+
+      case RX_CRC:
+        _rxState = RX_SYNC ;
+        if( c != _rxCrc ){
+          _reply( _rxCmd, PARAM_ERR_CRC ) ;
+          break;
+        }
+        _handle( _rxCmd ) ;
+        break;
+    }
+  }
+
+#endif
+}
+
+void StuParams::_handle( uint8_t cmd ){
+  motionParams_t* staging = &_block[ _active ^ 1 ] ;
+
+  switch( cmd ){
+
+    case PARAM_CMD_STAGE:
+      _staged = isValid( staging ) ;
+      _reply( cmd, _staged ? PARAM_OK : PARAM_ERR_INVALID ) ;
+      break;
+
+    case PARAM_CMD_COMMIT:
+      if( !_staged ){
+        _reply( cmd, PARAM_ERR_NOT_STAGED ) ;
+        break;
+      }
+      _pending = 1 ;  // acknowledged from apply()
+      break;
+
+    case PARAM_CMD_SAVE:
+      eepromWriteBlock( EEPROM_PARAMS_ADDR, &_block[ _active ], sizeof( motionParams_t ) ) ;
+      _reply( cmd, PARAM_OK ) ;
+      break;
+
+    case PARAM_CMD_LOAD:
+      _staged = eepromReadBlock( EEPROM_PARAMS_ADDR, staging, sizeof( motionParams_t ) ) && isValid( staging ) ;
+      _reply( cmd, _staged ? PARAM_OK : PARAM_ERR_EEPROM ) ;
+      break;
+
+    case PARAM_CMD_DEFAULTS:
+      setDefaults( staging ) ;
+      _staged = 1 ;
+      _reply( cmd, PARAM_OK ) ;
+      break;
+
+    case PARAM_CMD_GET:
+      _reply( cmd, PARAM_OK, &_block[ _active ], sizeof( motionParams_t ) ) ;
+      break;
+
+#ifdef PROFILE
+    case PARAM_CMD_PROFILE:
+      _reply( cmd, PARAM_OK, profileReport(), sizeof( profileReport_t ) ) ;
+      profileReset() ;
+      break;
+#endif
+
+#ifdef MEMORY_MONITOR
+    case PARAM_CMD_MEMORY:{
+      memoryReport_t r ;
+      memReport( &r ) ;
+      _reply( cmd, PARAM_OK, &r, sizeof( r ) ) ;
+      break;
+    }
+#endif
+
+#ifdef WARM_BOOT
+    case PARAM_CMD_RECALIBRATE:
+      bootInvalidate() ;
+      _reply( cmd, PARAM_OK ) ;
+      break;
+#endif
+
+#ifdef RECORDER
+    case PARAM_CMD_RECORD:
+    case PARAM_CMD_PLAY:
+    case PARAM_CMD_STOP:{
+      uint8_t status = PARAM_OK ;
+      recordInfo_t r ;
+
+      if( cmd == PARAM_CMD_RECORD && !recorder.record() ){
+        status = PARAM_ERR_INVALID ;    // busy
+      }
+      else if( cmd == PARAM_CMD_PLAY && !recorder.play() ){
+        status = PARAM_ERR_EEPROM ;     // busy or nothing stored
+      }
+      else if( cmd == PARAM_CMD_STOP ){
+        recorder.stop() ;
+      }
+      recorder.info( &r ) ;
+      _reply( cmd, status, &r, sizeof( r ) ) ;
+      break;
+    }
+#endif
+
+    default:
+      _reply( cmd, PARAM_ERR_COMMAND ) ;
+      break;
+  }
+
+}
+
+void StuParams::_reply( uint8_t cmd, uint8_t status, const void* data, uint8_t len ){
+#ifdef PARAM_SERIAL
+  const uint8_t* p = (const uint8_t*)data ;
+  uint8_t crc ;
+
+  cmd |= 0x80 ;
+  len += 1 ; // status byte
+
+  MY_SERIAL.write( PARAM_SYNC ) ;
+  MY_SERIAL.write( cmd ) ;
+  MY_SERIAL.write( len ) ;
+  MY_SERIAL.write( status ) ;
+  crc = _crc8_ccitt_update( 0, cmd ) ;
+  crc = _crc8_ccitt_update( crc, len ) ;
+  crc = _crc8_ccitt_update( crc, status ) ;
+
+  for( uint8_t i = 0; i + 1 < len; i++ ){
+    MY_SERIAL.write( p[ i ] ) ;
+    crc = _crc8_ccitt_update( crc, p[ i ] ) ;
+  }
+  MY_SERIAL.write( crc ) ;
+#endif
+}
@@ -0,0 +1,143 @@
+/**************************************************************************/
+/*!
+    @file     stu_params.h
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Live-tunable motion parameters. A compact binary serial protocol stages
+    a new parameter block, which is swapped in atomically at the next
+    control-period boundary (apply()) without stopping motion. The active
+    block can be persisted to EEPROM with a CRC and is reloaded at boot.
+
+    Frame (both directions):
+      0xA5 | cmd | len | payload[len] | crc8
+    crc8 is CRC-8/CCITT over cmd, len and payload. Replies set bit 7 of cmd
+    and carry a status byte (plus the block for PARAM_CMD_GET).
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+    v0.0.2 - PARAM_CMD_PROFILE dumps and clears the loop profiler table.
+    v0.0.3 - PARAM_CMD_MEMORY reports free RAM and the stack high-water mark.
+    v0.0.4 - PARAM_CMD_RECALIBRATE forces a cold boot (calibration sweep).
+    v0.0.5 - PARAM_CMD_RECORD, _PLAY and _STOP drive the trajectory recorder.
+
+*/
+/**************************************************************************/
+#pragma once
+
+#include "Arduino.h"
+#include "panTilt_config.h"
+#include "SETTINGS.h"
+#include "stuMarkov.h"
+#include "stu_eeprom.h"
+#include "stu_scheduler.h"
+#include "stu_profile.h"
+#include "stu_memory.h"
+#include "stu_boot.h"
+#include "stu_record.h"
+
+#define PARAMS_VERSION      1
+#define PARAM_SYNC          0xA5
+
+#define PARAM_SPEED_STATES  3
+#define PARAM_SHAKE_STATES  2
+
+// motionParams_t.flags
+#define PARAM_FLAG_SPEED    0x01 // use block speed alias table instead of PROGMEM model
+#define PARAM_FLAG_SHAKE    0x02 // use block shake alias table instead of PROGMEM model
+
+typedef enum {
+  PARAM_CMD_STAGE     = 0x01 , // payload: motionParams_t
+  PARAM_CMD_COMMIT    = 0x02 , // swap staged block in at next control period
+  PARAM_CMD_SAVE      = 0x03 , // persist active block to EEPROM
+  PARAM_CMD_LOAD      = 0x04 , // stage block stored in EEPROM
+  PARAM_CMD_DEFAULTS  = 0x05 , // stage compile-time defaults
+  PARAM_CMD_GET       = 0x06 , // reply with active block
+  PARAM_CMD_PROFILE   = 0x07 , // reply with profileReport_t and clear it (PROFILE builds)
+  PARAM_CMD_MEMORY    = 0x08 , // reply with memoryReport_t (MEMORY_MONITOR builds)
+  PARAM_CMD_RECALIBRATE = 0x09 , // clear the warm boot record (WARM_BOOT builds)
+  PARAM_CMD_RECORD    = 0x0A , // start recording, reply with recordInfo_t (RECORDER builds)
+  PARAM_CMD_PLAY      = 0x0B , // replay the stored recording, reply with recordInfo_t
+  PARAM_CMD_STOP      = 0x0C   // stop recording or playback, reply with recordInfo_t
+}paramCmd_e;
+
+typedef enum {
+  PARAM_OK = 0        ,
+  PARAM_ERR_CRC       ,
+  PARAM_ERR_LENGTH    ,
+  PARAM_ERR_INVALID   ,
+  PARAM_ERR_COMMAND   ,
+  PARAM_ERR_NOT_STAGED,
+  PARAM_ERR_EEPROM
+}paramStatus_e;
+
+
+typedef struct motionParams_t{
+
+  uint8_t
+    version ,
+    flags ,
+    dirChangeProb ,   // DIRECTION_CHANGE_PROBABILITY
+    pauseMean ,       // seconds between pauses (mean)
+    pauseVariance ,   // seconds^2
+    minX ,            // soft limits, inside SERVO_MIN/MAX_*_AXIS
+    maxX ,
+    minY ,
+    maxY ;
+
+  aliasEntry_t
+    speed[ PARAM_SPEED_STATES * PARAM_SPEED_STATES ] ,
+    shake[ PARAM_SHAKE_STATES * PARAM_SHAKE_STATES ] ;
+
+}motionParams_t;
+
+
+class StuParams {
+
+public:
+
+  StuParams( void ) ;
+
+  void
+    begin( void ) ,
+    poll( void ) ,
+    apply( void ) ,
+    setApplyCallback( Callback f ) ;
+
+  const motionParams_t&
+    get( void ) const ;
+
+  static bool
+    isValid( const motionParams_t* p ) ;
+
+  static void
+    setDefaults( motionParams_t* p ) ;
+
+private:
+
+  void
+    _handle( uint8_t cmd ) ,
+    _reply( uint8_t cmd, uint8_t status, const void* data = NULL, uint8_t len = 0 ) ;
+
+  motionParams_t
+    _block[ 2 ] ;         // double buffer, _block[ _active ] is live
+
+  uint8_t
+    _active ,
+    _rxState ,
+    _rxCmd ,
+    _rxLen ,
+    _rxPos ,
+    _rxCrc ;
+
+  bool
+    _staged ,             // inactive block holds a valid staged block
+    _pending ;            // swap requested for the next apply()
+
+  Callback
+    _callback ;
+
+};
+
+extern StuParams params;
@@ -0,0 +1,129 @@
+/**************************************************************************/
+/*!
+    @file     stu_pattern.cpp
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Deterministic "lure" patterns (Lissajous, spiral, zig-zag, figure-eight)
+    generated from a fixed-point sine table in PROGMEM. Evaluation is
+    integer-only and O(1) per sample; the only RAM used is one phase
+    accumulator per axis (plus the selected pattern).
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+
+*/
+/**************************************************************************/
+
+#include "stu_pattern.h"
+
+// Quarter sine wave, sin(i * PI/128) * 255 for i = 0..64. Entry 64 is kept
+// so interpolation never needs to wrap.
+static const uint8_t sineTable[ 65 ] PROGMEM = {
+    0,   6,  13,  19,  25,  31,  37,  44,  50,  56,  62,  68,  74,
+   80,  86,  92,  98, 103, 109, 115, 120, 126, 131, 136, 142, 147,
+  152, 157, 162, 167, 171, 176, 180, 185, 189, 193, 197, 201, 205,
+  208, 212, 215, 219, 222, 225, 228, 231, 233, 236, 238, 240, 242,
+  244, 246, 247, 249, 250, 251, 252, 253, 254, 254, 255, 255, 255
+};
+
+//                          shapeX         shapeY         rateX/Y  env offsetY
+static const pattern_t patternTable[ PATTERN_COUNT ] PROGMEM = {
+  /* PATTERN_LISSAJOUS    */ { WAVE_SINE,     WAVE_SINE,      3,  2,  0, 0x4000 },
+  /* PATTERN_SPIRAL       */ { WAVE_SINE,     WAVE_SINE,      4,  1,  1, 0x4000 },
+  /* PATTERN_ZIGZAG       */ { WAVE_TRIANGLE, WAVE_TRIANGLE,  1,  6,  0, 0x0000 },
+  /* PATTERN_FIGURE_EIGHT */ { WAVE_SINE,     WAVE_SINE,      1,  2,  0, 0x0000 }
+};
+
+
+StuPattern::StuPattern( void ):_pattern( PATTERN_LISSAJOUS ){
+  reset();
+
+}
+
+void StuPattern::setPattern( pattern_e p ){
+  _pattern = p < PATTERN_COUNT ? p : PATTERN_LISSAJOUS ;
+  reset();
+
+}
+
+pattern_e StuPattern::getPattern( void ) const {
+  return (pattern_e)_pattern ;
+}
+
+void StuPattern::reset( void ){
+  _phaseX = 0 ;
+  _phaseY = pgm_read_word( &patternTable[ _pattern ].offsetY ) ;
+
+}
+
+// Advance both accumulators. For envelope patterns (spiral) the Y
+// accumulator holds the slow amplitude phase instead of the Y angle.
+void StuPattern::step( uint8_t speed ){
+  const pattern_t* p = &patternTable[ _pattern ] ;
+  uint16_t inc = speed * PATTERN_PHASE_STEP ;
+
+  _phaseX += inc * pgm_read_byte( &p->rateX ) ;
+
+  if( pgm_read_byte( &p->envelope ) ){
+    _phaseY += speed * PATTERN_ENVELOPE_STEP * pgm_read_byte( &p->rateY ) ;
+  }
+  else{
+    _phaseY += inc * pgm_read_byte( &p->rateY ) ;
+  }
+
+}
+
+int StuPattern::_waveX( void ) const {
+  const pattern_t* p = &patternTable[ _pattern ] ;
+  int w = wave( pgm_read_byte( &p->shapeX ), _phaseX ) ;
+
+  if( pgm_read_byte( &p->envelope ) ){
+    w = ( w * ( ( wave( WAVE_TRIANGLE, _phaseY ) + 255 ) >> 2 ) ) >> 7 ;
+  }
+
+  return w ;
+}
+
+int StuPattern::_waveY( void ) const {
+  const pattern_t* p = &patternTable[ _pattern ] ;
+  int w ;
+
+  if( pgm_read_byte( &p->envelope ) ){
+    w = wave( pgm_read_byte( &p->shapeY ), _phaseX + pgm_read_word( &p->offsetY ) ) ;
+    w = ( w * ( ( wave( WAVE_TRIANGLE, _phaseY ) + 255 ) >> 2 ) ) >> 7 ;
+  }
+  else{
+    w = wave( pgm_read_byte( &p->shapeY ), _phaseY ) ;
+  }
+
+  return w ;
+}
+
+// Returns -255..255 for one full cycle over the 16 bit phase.
+int StuPattern::wave( uint8_t shape, uint16_t phase ){
+
+  if( shape == WAVE_TRIANGLE ){
+    int tri = phase >> 7 ;              // 0..511
+    if( tri > 255 ){
+      tri = 511 - tri ;
+    }
+    return ( tri << 1 ) - 255 ;
+  }
+
+  uint8_t quadrant = phase >> 14 ;
+  uint8_t idx = ( phase >> 8 ) & 0x3F ;
+  uint8_t frac = phase & 0xFF ;
+
+  if( quadrant & 1 ){                   // falling quarter, mirror the table
+    idx = 63 - idx ;
+    frac = 255 - frac ;
+  }
+
+  int a = pgm_read_byte( &sineTable[ idx ] ) ;
+  int b = pgm_read_byte( &sineTable[ idx + 1 ] ) ;
+  int val = a + ( ( ( b - a ) * frac ) >> 8 ) ;
+
+  return ( quadrant & 2 ) ? -val : val ;
+}
@@ -0,0 +1,102 @@
+/**************************************************************************/
+/*!
+    @file     stu_pattern.h
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Deterministic "lure" patterns (Lissajous, spiral, zig-zag, figure-eight)
+    generated from a fixed-point sine table in PROGMEM. Evaluation is
+    integer-only and O(1) per sample; the only RAM used is one phase
+    accumulator per axis (plus the selected pattern).
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+    v0.0.2 - getX()/getY() take the axis type as a template argument.
+
+*/
+/**************************************************************************/
+#pragma once
+
+#include "Arduino.h"
+#include <avr/pgmspace.h>
+#include "stuPanTilt.h"
+
+// Phase advance per speed unit (65536 == one full cycle of the base wave)
+#define PATTERN_PHASE_STEP    64
+#define PATTERN_ENVELOPE_STEP 8
+
+typedef enum pattern_e{
+  PATTERN_LISSAJOUS = 0 ,
+  PATTERN_SPIRAL        ,
+  PATTERN_ZIGZAG        ,
+  PATTERN_FIGURE_EIGHT  ,
+  PATTERN_COUNT
+}pattern_e;
+
+typedef enum wave_e{
+  WAVE_SINE = 0 ,
+  WAVE_TRIANGLE
+}wave_e;
+
+// Flash-resident pattern descriptor
+typedef struct pattern_t{
+
+  uint8_t
+    shapeX ,   // wave_e
+    shapeY ,
+    rateX ,    // phase multiplier per axis
+    rateY ,
+    envelope ; // 1 == amplitude follows slow triangle (spiral)
+
+  uint16_t
+    offsetY ;  // phase offset of Y axis (0x4000 == 90 degrees)
+
+}pattern_t;
+
+
+class StuPattern {
+
+public:
+
+  StuPattern( void ) ;
+
+  void
+    setPattern( pattern_e p ) ,
+    reset( void ) ,
+    step( uint8_t speed ) ;
+
+  pattern_e
+    getPattern( void ) const ;
+
+  template< class AXIS >
+  int getX( void ) const {
+    return _toAngle( AXIS::midAngle, ( AXIS::maxAngle - AXIS::minAngle ) >> 1, _waveX() ) ;
+  }
+
+  template< class AXIS >
+  int getY( void ) const {
+    return _toAngle( AXIS::midAngle, ( AXIS::maxAngle - AXIS::minAngle ) >> 1, _waveY() ) ;
+  }
+
+  static int
+    wave( uint8_t shape, uint16_t phase ) ;
+
+private:
+
+  int
+    _waveX( void ) const ,
+    _waveY( void ) const ;
+
+  static int _toAngle( int midAngle, int halfSpan, int w ){
+    return midAngle + ( ( w * halfSpan ) >> 8 ) ;
+  }
+
+  uint16_t
+    _phaseX ,
+    _phaseY ;
+
+  uint8_t
+    _pattern ;
+
+};
@@ -0,0 +1,60 @@
+/**************************************************************************/
+/*!
+    @file     stu_profile.cpp
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Scoped loop() stage timing, accumulated in a fixed RAM table.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+
+*/
+/**************************************************************************/
+
+#include "stu_profile.h"
+
+#ifdef PROFILE
+
+static profileReport_t report ;
+static uint32_t resetTime ;
+
+
+void profileReset( void ){
+  memset( &report, 0, sizeof( report ) ) ;
+  resetTime = millis() ;
+
+}
+
+// Stops at 65535 samples per stage; sum can't wrap before ~71 minutes.
+void profileAdd( uint8_t stage, uint32_t us ){
+  profileStat_t* s = &report.stat[ stage ] ;
+
+  if( s->count == 0xFFFF ){
+    return ;
+  }
+  if( s->count == 0 || us < s->min ){
+    s->min = us ;
+  }
+  if( us > s->max ){
+    s->max = us ;
+  }
+  s->count++ ;
+  s->sum += us ;
+
+}
+
+void profileLoop( void ){
+  if( report.loops != 0xFFFF ){
+    report.loops++ ;
+  }
+
+}
+
+const profileReport_t* profileReport( void ){
+  report.elapsed = millis() - resetTime ;
+  return &report ;
+}
+
+#endif // PROFILE
@@ -0,0 +1,102 @@
+/**************************************************************************/
+/*!
+    @file     stu_profile.h
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Scoped loop() stage timing. PROFILE_SCOPE( stage ) times the rest of the
+    enclosing block with micros() (4 us resolution; Timer1 belongs to the
+    Servo library and is reset every frame, so its count can't be used) and
+    accumulates count/min/max/sum per stage in a fixed RAM table.
+    PROFILE_LOOP() counts loop passes for the loop rate.
+
+    The table is read and cleared with the PARAM_CMD_PROFILE serial command
+    (stu_params.h). Without PROFILE defined every probe compiles to nothing.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+
+*/
+/**************************************************************************/
+#pragma once
+
+#include "Arduino.h"
+#include "panTilt_config.h"
+
+typedef enum {
+  PROF_PARAMS = 0 ,   // params.poll() + apply()
+  PROF_MOTION     ,   // getDeltaPosition() / pattern / spline
+  PROF_SHAKE      ,   // panTilt.shake()
+  PROF_SCHEDULER  ,   // scheduler.run(), includes pause callbacks
+  PROF_UPDATE     ,   // panTilt.update(): dial filter, mode changes, setpoints
+  PROF_LOOP       ,   // whole loop() pass
+  PROF_STAGE_COUNT
+}profStage_e;
+
+// Wire layout of the PARAM_CMD_PROFILE reply, times in microseconds
+typedef struct profileStat_t{
+
+  uint16_t
+    count ;
+
+  uint32_t
+    min ,
+    max ,
+    sum ;
+
+}profileStat_t;
+
+typedef struct profileReport_t{
+
+  uint16_t
+    loops ;           // loop passes since the last reset
+
+  uint32_t
+    elapsed ;         // ms since the last reset
+
+  profileStat_t
+    stat[ PROF_STAGE_COUNT ] ;
+
+}profileReport_t;
+
+
+#ifdef PROFILE
+
+void
+  profileAdd( uint8_t stage, uint32_t us ) ,
+  profileLoop( void ) ,
+  profileReset( void ) ;
+
+const profileReport_t*
+  profileReport( void ) ;
+
+class StuProfileScope {
+
+public:
+
+  StuProfileScope( uint8_t stage ):_stage( stage ), _start( micros() ){}
+
+  ~StuProfileScope( void ){
+    profileAdd( _stage, micros() - _start ) ;
+  }
+
+private:
+
+  uint8_t
+    _stage ;
+
+  uint32_t
+    _start ;
+
+};
+
+  #define PROFILE_SCOPE( stage ) StuProfileScope _profileScope( stage )
+  #define PROFILE_LOOP()         profileLoop()
+
+#else
+
+  #define PROFILE_SCOPE( stage )
+  #define PROFILE_LOOP()
+
+#endif
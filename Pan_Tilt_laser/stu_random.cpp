@@ -0,0 +1,112 @@
+/**************************************************************************/
+/*!
+    @file     stu_random.cpp
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Small seedable xorshift32 generator for the hot paths. Replaces
+    Arduino random(), which does 32 bit modulo/division on the AVR.
+    Bounded draws use Lemire's multiply-shift with rejection, so they are
+    unbiased and only divide on the rare rejection path.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+
+*/
+/**************************************************************************/
+
+#include "stu_random.h"
+
+StuRandom rng;
+
+
+StuRandom::StuRandom( uint32_t s ){
+  seed( s ) ;
+
+}
+
+// xorshift has a single fixed point at zero, so remap it.
+void StuRandom::seed( uint32_t s ){
+  _state = s ? s : 0x9E3779B9UL ;
+
+  for( uint8_t i = 0; i < 4; i++ ){ // stir small seeds (e.g. one ADC reading)
+    next() ;
+  }
+
+}
+
+void StuRandom::setState( uint32_t state ){
+  _state = state ? state : 0x9E3779B9UL ;
+
+}
+
+uint32_t StuRandom::getState( void ) const {
+  return _state ;
+}
+
+uint32_t StuRandom::next( void ){
+  uint32_t x = _state ;
+  x ^= x << 13 ;
+  x ^= x >> 17 ;
+  x ^= x << 5 ;
+  _state = x ;
+  return x ;
+}
+
+uint8_t StuRandom::nextByte( void ){
+  return next() >> 24 ;
+}
+
+uint16_t StuRandom::below( uint16_t n ){
+  uint32_t m = (uint32_t)( next() >> 16 ) * n ;
+  uint16_t low = (uint16_t)m ;
+
+  if( low < n ){
+    uint16_t t = (uint16_t)( -n ) % n ;
+    while( low < t ){
+      m = (uint32_t)( next() >> 16 ) * n ;
+      low = (uint16_t)m ;
+    }
+  }
+  return m >> 16 ;
+}
+
+int StuRandom::range( int lo, int hi ){
+  if( hi <= lo ){
+    return lo ;
+  }
+  return lo + below( hi - lo ) ;
+}
+
+
+#if defined( SERIAL_DEBUG ) && defined( RANDOM_BENCHMARK )
+
+#define RANDOM_BENCH_LOOPS 1000
+
+// micros() has 4 us (64 cycle) resolution, so time a batch and report
+// cycles per call at F_CPU.
+void randomBenchmark( void ){
+  volatile long sink = 0 ;
+  unsigned long t0, tRandom, tRng ;
+
+  t0 = micros() ;
+  for( int i = 0; i < RANDOM_BENCH_LOOPS; i++ ){
+    sink += random( 1001 ) ;
+  }
+  tRandom = micros() - t0 ;
+
+  t0 = micros() ;
+  for( int i = 0; i < RANDOM_BENCH_LOOPS; i++ ){
+    sink += rng.below( 1001 ) ;
+  }
+  tRng = micros() - t0 ;
+
+  MY_SERIAL.print(F("random(1001) cycles/call: "));
+  MY_SERIAL.println( tRandom * ( F_CPU / 1000000UL ) / RANDOM_BENCH_LOOPS ) ;
+  MY_SERIAL.print(F("rng.below(1001) cycles/call: "));
+  MY_SERIAL.println( tRng * ( F_CPU / 1000000UL ) / RANDOM_BENCH_LOOPS ) ;
+
+}
+
+#endif
@@ -0,0 +1,60 @@
+/**************************************************************************/
+/*!
+    @file     stu_random.h
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Small seedable xorshift32 generator for the hot paths. Replaces
+    Arduino random(), which does 32 bit modulo/division on the AVR.
+    Bounded draws use Lemire's multiply-shift with rejection, so they are
+    unbiased and only divide on the rare rejection path.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+
+*/
+/**************************************************************************/
+#pragma once
+
+#include "Arduino.h"
+#include "panTilt_config.h"
+
+//#define RANDOM_BENCHMARK // print cycles per call vs random() at boot
+
+
+class StuRandom {
+
+public:
+
+  StuRandom( uint32_t seed = 1 ) ;
+
+  void
+    seed( uint32_t s ) ,
+    setState( uint32_t state ) ;
+
+  uint32_t
+    getState( void ) const ,
+    next( void ) ;
+
+  uint8_t
+    nextByte( void ) ;
+
+  uint16_t
+    below( uint16_t n ) ;          // [0, n)
+
+  int
+    range( int lo, int hi ) ;      // [lo, hi)
+
+private:
+
+  uint32_t
+    _state ;
+
+};
+
+extern StuRandom rng;
+
+#if defined( SERIAL_DEBUG ) && defined( RANDOM_BENCHMARK )
+void randomBenchmark( void ) ;
+#endif
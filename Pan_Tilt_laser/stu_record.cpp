@@ -0,0 +1,278 @@
+/**************************************************************************/
+/*!
+    @file     stu_record.cpp
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Trajectory recorder and player: delta/varint records in an EEPROM
+    ring, streamed back one record at a time.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+
+*/
+/**************************************************************************/
+
+#include "stu_record.h"
+
+#ifdef RECORDER
+
+#include "stu_log.h"
+
+static_assert( sizeof( recordHeader_t ) + 2 <= EEPROM_REC_HDR_SIZE, "recordHeader_t does not fit its EEPROM block" ) ;
+
+StuRecorder recorder;
+
+
+StuRecorder::StuRecorder( void ):_valid( false ), _state( REC_IDLE ), _pos( 0 ), _x( 0 ), _y( 0 ){
+
+}
+
+void StuRecorder::begin( void ){
+  _valid = eepromReadBlock( EEPROM_REC_HDR_ADDR, &_header, sizeof( _header ) ) &&
+           _header.start < EEPROM_REC_SIZE && _header.length <= EEPROM_REC_SIZE ;
+
+  if( !_valid ){
+    memset( &_header, 0, sizeof( _header ) ) ;
+  }
+  _state = REC_IDLE ;
+
+}
+
+// The new recording starts where the stored one ends. Its header goes out
+// first with length 0, so a power cut mid-recording leaves an empty
+// recording rather than a half-overwritten one.
+bool StuRecorder::record( void ){
+  if( _state != REC_IDLE ){
+    return false ;
+  }
+
+  _header.start = ( _header.start + _header.length ) % EEPROM_REC_SIZE ;
+  _header.length = 0 ;
+  _header.rawBytes = 0 ;
+  _header.records = 0 ;
+  eepromWriteBlock( EEPROM_REC_HDR_ADDR, &_header, sizeof( _header ) ) ;
+  _valid = true ;
+
+  _pos = 0 ;
+  _x = 0 ;
+  _y = 0 ;
+  _last = millis() >> REC_TICK_SHIFT ;
+  _due = _last ;                 // next sample (recording)
+  _state = REC_RECORDING ;
+  LOG( REC, INFO, "Recording" ) ;
+  return true ;
+}
+
+void StuRecorder::stop( void ){
+
+  if( _state == REC_RECORDING ){
+    eepromWriteBlock( EEPROM_REC_HDR_ADDR, &_header, sizeof( _header ) ) ;
+    LOGV( REC, INFO, "Recorded bytes: ", _header.length ) ;
+    LOGV( REC, INFO, "Raw bytes: ", _header.rawBytes ) ;
+  }
+  _state = REC_IDLE ;
+
+}
+
+void StuRecorder::sample( int x, int y ){
+  if( _state != REC_RECORDING ){
+    return ;
+  }
+
+  uint32_t now = millis() >> REC_TICK_SHIFT ;
+
+  if( (int32_t)( now - _due ) < 0 ){
+    return ;
+  }
+  _due = now + ( REC_PERIOD_MS >> REC_TICK_SHIFT ) ;
+
+  // A raw logger stores every sample, moved or not
+  if( _header.rawBytes <= 0xFFFF - REC_RAW_MOVE ){
+    _header.rawBytes += REC_RAW_MOVE ;
+  }
+
+  if( x == _x && y == _y ){
+    return ;
+  }
+  if( _start( REC_MOVE ) ){
+    _putSigned( x - _x ) ;
+    _putSigned( y - _y ) ;
+    _x = x ;
+    _y = y ;
+  }
+
+}
+
+void StuRecorder::pause( uint16_t ms, bool laser ){
+  if( _state != REC_RECORDING ){
+    return ;
+  }
+
+  if( _header.rawBytes <= 0xFFFF - REC_RAW_PAUSE ){
+    _header.rawBytes += REC_RAW_PAUSE ;
+  }
+
+  if( _start( REC_PAUSE ) ){
+    _putVarint( ms ) ;
+    _put( laser ) ;
+  }
+
+}
+
+void StuRecorder::info( recordInfo_t* r ) const {
+  r->state = _state ;
+  r->header = _header ;
+
+}
+
+// tag | dt byte (plus dt varint when it doesn't fit in 6 bits). Stops the
+// recording when the ring has no room left for a worst-case record.
+bool StuRecorder::_start( uint8_t tag ){
+  if( _pos + REC_MAX_RECORD > EEPROM_REC_SIZE ){
+    LOG( REC, WARN, "Recording full" ) ;
+    stop() ;
+    return false ;
+  }
+
+  uint32_t now = millis() >> REC_TICK_SHIFT ;
+  uint32_t dt = now - _last ;
+  _last = now ;
+
+  if( dt < REC_DT_ESCAPE ){
+    _put( ( tag << 6 ) | dt ) ;
+  }
+  else{
+    _put( ( tag << 6 ) | REC_DT_ESCAPE ) ;
+    _putVarint( dt ) ;
+  }
+  _header.records++ ;
+  return true ;
+}
+
+// EEPROM.update() blocks ~3.4 ms per changed byte; at REC_PERIOD_MS a
+// 3-byte move costs about a quarter of the loop while recording.
+void StuRecorder::_put( uint8_t b ){
+  EEPROM.update( EEPROM_REC_ADDR + ( _header.start + _pos ) % EEPROM_REC_SIZE, b ) ;
+  _header.length = ++_pos ;
+
+}
+
+void StuRecorder::_putVarint( uint32_t v ){
+  while( v >= 0x80 ){
+    _put( v | 0x80 ) ;
+    v >>= 7 ;
+  }
+  _put( v ) ;
+
+}
+
+void StuRecorder::_putSigned( int16_t v ){
+  _putVarint( (uint16_t)( ( v << 1 ) ^ ( v >> 15 ) ) ) ;
+
+}
+
+bool StuRecorder::play( void ){
+  if( _state != REC_IDLE || !_valid || !_header.length ){
+    return false ;
+  }
+
+  _pos = 0 ;
+  _x = 0 ;
+  _y = 0 ;
+  _state = REC_PLAYING ;
+  _due = 0 ;
+  _next() ;
+  _due = millis() >> REC_TICK_SHIFT ; // first record (the start position) at once
+  LOGV( REC, INFO, "Playing records: ", _header.records ) ;
+  return true ;
+}
+
+bool StuRecorder::playing( void ) const {
+  return _state == REC_PLAYING ;
+}
+
+// Only the pending record's tag and due time are held; its payload is read
+// when it is applied.
+recEvent_e StuRecorder::poll( void ){
+  recEvent_e e ;
+
+  if( _state != REC_PLAYING || (int32_t)( ( millis() >> REC_TICK_SHIFT ) - _due ) < 0 ){
+    return REC_EVENT_NONE ;
+  }
+
+  if( _tag == REC_MOVE ){
+    _x += _getSigned() ;
+    _y += _getSigned() ;
+    e = REC_EVENT_MOVE ;
+  }
+  else{
+    _pauseMs = _getVarint() ;
+    _pauseLaser = _get() ;
+    e = REC_EVENT_PAUSE ;
+  }
+
+  _next() ;
+  return e ;
+}
+
+// Read the next record's tag and dt; the end of the recording ends playback.
+void StuRecorder::_next( void ){
+  if( _pos >= _header.length ){
+    LOG( REC, INFO, "Playback done" ) ;
+    _state = REC_IDLE ;
+    return ;
+  }
+
+  uint8_t b = _get() ;
+  uint32_t dt = b & REC_DT_ESCAPE ;
+
+  if( dt == REC_DT_ESCAPE ){
+    dt = _getVarint() ;
+  }
+  _tag = b >> 6 ;
+  _due += dt ;
+
+}
+
+uint8_t StuRecorder::_get( void ){
+  return EEPROM.read( EEPROM_REC_ADDR + ( _header.start + _pos++ ) % EEPROM_REC_SIZE ) ;
+}
+
+uint32_t StuRecorder::_getVarint( void ){
+  uint32_t v = 0 ;
+  uint8_t shift = 0 ;
+  uint8_t b ;
+
+  do{
+    b = _get() ;
+    v |= (uint32_t)( b & 0x7F ) << shift ;
+    shift += 7 ;
+  }while( ( b & 0x80 ) && shift < 35 ) ;
+
+  return v ;
+}
+
+int16_t StuRecorder::_getSigned( void ){
+  uint16_t v = _getVarint() ;
+  return ( v >> 1 ) ^ -( v & 1 ) ;
+}
+
+int StuRecorder::getX( void ) const {
+  return _x ;
+}
+
+int StuRecorder::getY( void ) const {
+  return _y ;
+}
+
+uint16_t StuRecorder::getPauseTime( void ) const {
+  return _pauseMs ;
+}
+
+bool StuRecorder::getPauseLaser( void ) const {
+  return _pauseLaser ;
+}
+
+#endif
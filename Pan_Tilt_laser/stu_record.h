@@ -0,0 +1,188 @@
+/**************************************************************************/
+/*!
+    @file     stu_record.h
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Trajectory recorder and player. While recording, the loop's target
+    angles are sampled every REC_PERIOD_MS and pauses are logged. Each
+    record is written to EEPROM as
+
+      tag:2 | dt:6 [ dt varint ] | payload
+
+    tag is a recTag_e. dt is the time since the previous record in
+    REC_TICK_MS units; 63 means a varint with the full value follows.
+    REC_MOVE carries the zig-zag varint deltas of x and y, and is skipped
+    when neither changed. REC_PAUSE carries the pause length in ms
+    (varint) and the laser flag. A typical move is 3 bytes, where a raw
+    sample { uint32 ms, int16 x, int16 y } takes 8.
+
+    The recording area is a ring. Each recording starts where the last one
+    ended, so the cell wear is spread over the whole area. The header
+    (start, length and raw-equivalent size) is a CRC block that is written
+    once per recording.
+
+    Playback streams one record at a time straight from EEPROM at the
+    recorded timing. RAM use is fixed, whatever the recording length.
+
+    Controlled over the parameter interface: PARAM_CMD_RECORD, _PLAY and
+    _STOP each reply with recordInfo_t, whose rawBytes / length is the
+    compression ratio (Extra/Tools/params_frame.py decode-record).
+
+    Enabled with RECORDER; otherwise the REC_* macros compile to nothing.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+
+*/
+/**************************************************************************/
+#pragma once
+
+#include "Arduino.h"
+#include "panTilt_config.h"
+#include "stu_eeprom.h"
+
+#define REC_PERIOD_MS   40  // move sampling period while recording
+#define REC_TICK_SHIFT  2   // dt unit is 1 << REC_TICK_SHIFT ms
+#define REC_TICK_MS     ( 1 << REC_TICK_SHIFT )
+#define REC_DT_ESCAPE   0x3F
+#define REC_MAX_RECORD  12  // tag/dt + 5-byte dt varint + two 3-byte varints
+
+#define REC_RAW_MOVE    8   // uint32 ms, int16 x, int16 y
+#define REC_RAW_PAUSE   7   // uint32 ms, uint16 pause, uint8 laser
+
+typedef enum {
+  REC_MOVE  = 0 ,
+  REC_PAUSE = 1
+}recTag_e;
+
+typedef enum {
+  REC_IDLE = 0    ,
+  REC_RECORDING   ,
+  REC_PLAYING
+}recState_e;
+
+typedef enum {
+  REC_EVENT_NONE = 0 ,
+  REC_EVENT_MOVE     ,
+  REC_EVENT_PAUSE
+}recEvent_e;
+
+// EEPROM header of the stored recording
+typedef struct recordHeader_t{
+
+  uint16_t
+    start ,         // offset of the first record in the ring
+    length ,        // encoded bytes
+    rawBytes ,      // same events as raw fixed-size samples
+    records ;
+
+}recordHeader_t;
+
+// Wire layout of the PARAM_CMD_RECORD/_PLAY/_STOP reply
+typedef struct recordInfo_t{
+
+  uint8_t
+    state ;         // recState_e
+
+  recordHeader_t
+    header ;
+
+}recordInfo_t;
+
+
+#ifdef RECORDER
+
+class StuRecorder {
+
+public:
+
+  StuRecorder( void ) ;
+
+  void
+    begin( void ) ,
+    stop( void ) ,
+    sample( int x, int y ) ,
+    pause( uint16_t ms, bool laser ) ,
+    info( recordInfo_t* r ) const ;
+
+  bool
+    record( void ) ,
+    play( void ) ,             // false if nothing is stored
+    playing( void ) const ;
+
+  recEvent_e
+    poll( void ) ;             // playback: apply the next record when due
+
+  int
+    getX( void ) const ,
+    getY( void ) const ;
+
+  uint16_t
+    getPauseTime( void ) const ;
+
+  bool
+    getPauseLaser( void ) const ;
+
+private:
+
+  bool
+    _start( uint8_t tag ) ;
+
+  void
+    _put( uint8_t b ) ,
+    _putVarint( uint32_t v ) ,
+    _putSigned( int16_t v ) ,
+    _next( void ) ;
+
+  uint8_t
+    _get( void ) ;
+
+  uint32_t
+    _getVarint( void ) ;
+
+  int16_t
+    _getSigned( void ) ;
+
+  recordHeader_t
+    _header ;
+
+  bool
+    _valid ;                   // _header describes a complete recording
+
+  uint8_t
+    _state ,
+    _tag ,                     // playback: tag of the pending record
+    _pauseLaser ;
+
+  uint16_t
+    _pos ,                     // byte offset from _header.start
+    _pauseMs ;
+
+  int16_t
+    _x ,
+    _y ;
+
+  uint32_t
+    _last ,                    // ticks of the previous record (recording)
+    _due ;                     // ticks of the next sample (recording) or of
+                               // the pending record (playback)
+
+};
+
+extern StuRecorder recorder;
+
+  #define REC_BEGIN()                   recorder.begin()
+  #define REC_SAMPLE( x, y )            recorder.sample( x, y )
+  #define REC_LOG_PAUSE( ms, l )        recorder.pause( ms, l )
+  #define REC_IS_PLAYING()              recorder.playing()
+
+#else
+
+  #define REC_BEGIN()
+  #define REC_SAMPLE( x, y )
+  #define REC_LOG_PAUSE( ms, l )
+  #define REC_IS_PLAYING()              false
+
+#endif
@@ -11,11 +11,14 @@
 
     @section  HISTORY
     v0.0.1 - First release
+    v0.0.2 - Diagnostics go through the buffered logger (stu_log.h).
+    v0.0.3 - Event flags packed into one byte.
 
 */
 /**************************************************************************/\
 
 #include "stu_scheduler.h"
+#include "stu_log.h"
 
 StuScheduler scheduler;
 
@@ -75,9 +78,7 @@ void Event::disable( void ){
 
 void Event::enable(){
 
-  #ifdef SERIAL_DEBUG
-  MY_SERIAL.println(F("EVENT enabled"));
-  #endif
+  LOG( SCHED, DEBUG, "EVENT enabled" );
 
   if( !_enabled ){
     resetPeriodic() ;
@@ -92,14 +93,13 @@ bool Event::enabled() const {
 Timer::Timer(time_t interval, bool enable){
   _timeDelta = interval ;
   _enabled = enable ;
+  _elapsed = 0 ;
   rolloverFlag = 0 ;
 
 }
 
 void Timer::start( void ){
-  #ifdef SERIAL_DEBUG
-  MY_SERIAL.println(F("TIMER START ENABLE"));
-  #endif
+  LOG( SCHED, DEBUG, "TIMER START ENABLE" );
   enable();
 
 }
@@ -110,14 +110,12 @@ void Timer::stop( void ){
 }
 
 void Timer::restart( void ){
-  #ifdef SERIAL_DEBUG
-    MY_SERIAL.println(F("Restart"));
-  #endif
+  LOG( SCHED, DEBUG, "Restart" );
   resetPeriodic();
 }
 
 void Timer::run( ){
-  _elapsed = true ;
+  _elapsed = 1 ;
 }
 
 bool Timer::check( timer_input_e action ){
@@ -127,11 +125,7 @@ bool Timer::check( timer_input_e action ){
 
   if( _elapsed ){ //TRUE == elapsed
 
-    #ifdef SERIAL_DEBUG
-    MY_SERIAL.print(F("Timer Elapsed!!!!\nDuration: "));
-    MY_SERIAL.println(_timeDelta);
-
-    #endif
+    LOGV( SCHED, DEBUG, "Timer Elapsed, duration: ", _timeDelta );
 
     _enabled = 0 ;
     _elapsed = 0;
@@ -177,27 +171,19 @@ void StuScheduler::begin( void ){
 void StuScheduler::addEvent( Event *t ){
 
   if(_tItr >= MAX_EVENTS){
-    #ifdef SERIAL_DEBUG
-    MY_SERIAL.println(F("TOO MANY EVENTS!!!"));
-    #endif
+    LOG( SCHED, ERROR, "TOO MANY EVENTS!!!" );
     return;
   }
 
   _Event[ _tItr ] = t;
   _tItr++;
 
-  #ifdef SERIAL_DEBUG
-  MY_SERIAL.print(F("Event Total: "));
-  MY_SERIAL.println( _tItr);
-
-  #endif
+  LOGV( SCHED, DEBUG, "Event Total: ", _tItr );
 
 }
 
 void StuScheduler::restart( void ){
-  #ifdef SERIAL_DEBUG
-    MY_SERIAL.println(F("Schedule Restart"));
-  #endif
+  LOG( SCHED, INFO, "Schedule Restart" );
 
   for(uint8_t i = 0; i < _tItr; i++){
     if( _Event[i]->enabled() ){
@@ -212,9 +198,7 @@ void StuScheduler::run( void ){
 
   // HANDLE ROLLOVER
   if( oldTime > currentTime ){ //rollover
-    #ifdef SERIAL_DEBUG
-    MY_SERIAL.println( F("MILLI ROLLOVER!!!!") );
-    #endif
+    LOG( SCHED, WARN, "MILLI ROLLOVER!!!!" );
     _milliRolloverFlag ^= 1; // Toggle rollover flag
   }
 
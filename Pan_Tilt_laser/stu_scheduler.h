@@ -11,6 +11,7 @@
 
     @section  HISTORY
     v0.0.1 - First release
+    v0.0.2 - Event flags packed into one byte; MAX_EVENTS cut to 8.
 
 */
 /**************************************************************************/
@@ -20,7 +21,9 @@
 #include "panTilt_config.h"
 #include <Time.h>
 
-#define MAX_EVENTS 20
+#define MAX_EVENTS 8 // pause, Markov update and one state change task per turret
+
+static_assert( PANTILT_TURRETS + 2 <= MAX_EVENTS, "each turret needs a scheduler event; raise MAX_EVENTS" ) ;
 
 typedef void (*Callback)(void);
 
@@ -52,13 +55,16 @@ public:
     time_t
       getNextEventTime( void ) const ;
 
-    bool
-      rolloverFlag ;
+    uint8_t
+      rolloverFlag : 1 ;
 
 
 protected:
-    bool
-      _enabled ;
+    // Packed with rolloverFlag into one byte. Only touched from loop()
+    // context, so the read-modify-write of the byte is safe.
+    uint8_t
+      _enabled : 1 ,
+      _elapsed : 1 ; // Timer only
 
 
     time_t
@@ -84,11 +90,6 @@ public:
     bool
       check( timer_input_e action = ELAPSE_DISABLE ) ;
 
-  private:
-    bool
-      _elapsed ;
-
-
 };
 
 class Task: public Event{
@@ -0,0 +1,114 @@
+/**************************************************************************/
+/*!
+    @file     stu_spline.cpp
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Smooth laser trajectories through sparse random waypoints. Each segment
+    is a Catmull-Rom spline evaluated by integer forward differencing, so a
+    sample costs three 32 bit adds per axis and random numbers are only
+    drawn once per segment instead of once per step.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+
+*/
+/**************************************************************************/
+
+#include "stu_spline.h"
+
+
+StuSpline::StuSpline( void ):_stepsLeft( 0 ){
+  memset( &_x, 0, sizeof( _x ) ) ;
+  memset( &_y, 0, sizeof( _y ) ) ;
+
+}
+
+// Park all control points on the axis midpoints. The first segments then
+// ease out of the center instead of jumping.
+void StuSpline::_reset( int midX, int midY ){
+
+  for( uint8_t i = 0; i < 4; i++ ){
+    _x.p[ i ] = midX ;
+    _y.p[ i ] = midY ;
+  }
+  _setupDifferences( &_x, SPLINE_MAX_SHIFT ) ;
+  _setupDifferences( &_y, SPLINE_MAX_SHIFT ) ;
+  _stepsLeft = 0 ;
+
+}
+
+void StuSpline::_step( void ){
+
+  _x.pos += _x.d1 ;
+  _x.d1  += _x.d2 ;
+  _x.d2  += _x.d3 ;
+
+  _y.pos += _y.d1 ;
+  _y.d1  += _y.d2 ;
+  _y.d2  += _y.d3 ;
+
+  _stepsLeft-- ;
+
+}
+
+int StuSpline::getX( void ) const {
+  return _toAngle( &_x ) ;
+}
+
+int StuSpline::getY( void ) const {
+  return _toAngle( &_y ) ;
+}
+
+// Faster Markov speed states give shorter segments (fewer steps between
+// waypoints).
+void StuSpline::_newSegment( uint8_t speed, int minX, int maxX, int minY, int maxY ){
+  int8_t shift = SPLINE_MAX_SHIFT + 1 - speed ;
+  shift = constrain( shift, SPLINE_MIN_SHIFT, SPLINE_MAX_SHIFT ) ;
+
+  _nextWaypoint( &_x, minX, maxX ) ;
+  _nextWaypoint( &_y, minY, maxY ) ;
+
+  _setupDifferences( &_x, shift ) ;
+  _setupDifferences( &_y, shift ) ;
+
+  _stepsLeft = 1 << shift ;
+
+}
+
+void StuSpline::_nextWaypoint( splineAxis_t* a, int minAngle, int maxAngle ){
+  a->p[ 0 ] = a->p[ 1 ] ;
+  a->p[ 1 ] = a->p[ 2 ] ;
+  a->p[ 2 ] = a->p[ 3 ] ;
+  a->p[ 3 ] = rng.range( minAngle, maxAngle + 1 ) ;
+
+}
+
+// Catmull-Rom: P(t) = ( A*t^3 + B*t^2 + C*t + D ) / 2, t = i * h, h = 2^-shift
+//   A = -p0 + 3p1 - 3p2 + p3
+//   B = 2p0 - 5p1 + 4p2 - p3
+//   C = -p0 + p2
+//   D = 2p1
+// The halving is folded into the shifts.
+void StuSpline::_setupDifferences( splineAxis_t* a, uint8_t shift ){
+  const int* p = a->p ;
+
+  long A = -p[ 0 ] + 3 * p[ 1 ] - 3 * p[ 2 ] + p[ 3 ] ;
+  long B = 2 * p[ 0 ] - 5 * p[ 1 ] + 4 * p[ 2 ] - p[ 3 ] ;
+  long C = -p[ 0 ] + p[ 2 ] ;
+
+  long h3 = 1L << ( SPLINE_FRAC_BITS - 1 - 3 * shift ) ; // h^3 / 2
+  long h2 = 1L << ( SPLINE_FRAC_BITS - 1 - 2 * shift ) ; // h^2 / 2
+  long h1 = 1L << ( SPLINE_FRAC_BITS - 1 - shift ) ;     // h / 2
+
+  a->pos = (long)p[ 1 ] << SPLINE_FRAC_BITS ;
+  a->d1  = A * h3 + B * h2 + C * h1 ;
+  a->d2  = 6 * A * h3 + 2 * B * h2 ;
+  a->d3  = 6 * A * h3 ;
+
+}
+
+int StuSpline::_toAngle( const splineAxis_t* a ){
+  return ( a->pos + ( 1L << ( SPLINE_FRAC_BITS - 1 ) ) ) >> SPLINE_FRAC_BITS ;
+}
@@ -0,0 +1,87 @@
+/**************************************************************************/
+/*!
+    @file     stu_spline.h
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Smooth laser trajectories through sparse random waypoints. Each segment
+    is a Catmull-Rom spline evaluated by integer forward differencing, so a
+    sample costs three 32 bit adds per axis and random numbers are only
+    drawn once per segment instead of once per step.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+    v0.0.2 - reset()/step() take the axis types as template arguments.
+
+*/
+/**************************************************************************/
+#pragma once
+
+#include "Arduino.h"
+#include "stuPanTilt.h"
+#include "stu_random.h"
+
+#define SPLINE_FRAC_BITS    21 // fixed-point fraction bits of the difference terms
+#define SPLINE_MIN_SHIFT    4  // fastest segment: 2^4 steps
+#define SPLINE_MAX_SHIFT    6  // slowest segment: 2^6 steps (keeps SPLINE_FRAC_BITS - 1 - 3*shift >= 0)
+
+typedef struct splineAxis_t{
+
+  int
+    p[ 4 ] ; // control points (waypoints), segment runs from p[1] to p[2]
+
+  long
+    pos ,    // current value, SPLINE_FRAC_BITS fixed point
+    d1 ,     // first forward difference
+    d2 ,     // second forward difference
+    d3 ;     // third forward difference (constant per segment)
+
+}splineAxis_t;
+
+
+class StuSpline {
+
+public:
+
+  StuSpline( void ) ;
+
+  template< class AXIS_X, class AXIS_Y >
+  void reset( void ){
+    _reset( AXIS_X::midAngle, AXIS_Y::midAngle ) ;
+  }
+
+  template< class AXIS_X, class AXIS_Y >
+  void step( uint8_t speed ){
+    if( _stepsLeft == 0 ){
+      _newSegment( speed, AXIS_X::minAngle, AXIS_X::maxAngle, AXIS_Y::minAngle, AXIS_Y::maxAngle ) ;
+    }
+    _step() ;
+  }
+
+  int
+    getX( void ) const ,
+    getY( void ) const ;
+
+private:
+
+  void
+    _reset( int midX, int midY ) ,
+    _step( void ) ,
+    _newSegment( uint8_t speed, int minX, int maxX, int minY, int maxY ) ;
+
+  static void
+    _nextWaypoint( splineAxis_t* a, int minAngle, int maxAngle ) ,
+    _setupDifferences( splineAxis_t* a, uint8_t shift ) ;
+
+  static int
+    _toAngle( const splineAxis_t* a ) ;
+
+  splineAxis_t
+    _x ,
+    _y ;
+
+  uint8_t
+    _stepsLeft ;
+
+};
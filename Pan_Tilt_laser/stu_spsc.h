@@ -0,0 +1,111 @@
+/**************************************************************************/
+/*!
+    @file     stu_spsc.h
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Lock-free single-producer/single-consumer ring buffer for handing data
+    between an ISR and the main loop without disabling interrupts.
+
+    The producer only writes _head, the consumer only writes _tail, and
+    both are uint8_t so every index load/store is a single (atomic) AVR
+    instruction. The slots themselves are not volatile, so each side
+    needs a compiler barrier: push() fills the slot before publishing
+    _head (release), and pop() reads _head before loading the slot
+    (acquire) and empties the slot before releasing _tail. Capacity must
+    be a power of two (at most 128) so wrap-around is a mask; all N slots
+    are usable because the indices run freely and only their difference
+    is used.
+
+    Extra/Tools/spsc_test.sh stress tests this on the host with the
+    producer and consumer on separate threads.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+    v0.0.2 - Acquire barrier in pop() between the empty check and the load.
+
+*/
+/**************************************************************************/
+#pragma once
+
+#include "Arduino.h"
+#include <util/atomic.h>
+
+#define SPSC_BARRIER() __asm__ __volatile__( "" ::: "memory" )
+
+
+template< typename T, uint8_t N >
+class StuSpsc {
+
+  static_assert( N && !( N & ( N - 1 ) ), "StuSpsc: capacity must be a power of two" );
+  static_assert( N <= 128, "StuSpsc: capacity must fit 8 bit free-running indices" );
+
+public:
+
+  StuSpsc( void ):_head( 0 ), _tail( 0 ), _dropped( 0 ){}
+
+  // Producer side. Returns false (and counts a drop) when full.
+  bool push( const T& item ){
+    uint8_t head = _head ;
+
+    if( (uint8_t)( head - _tail ) >= N ){
+      if( _dropped != 0xFF ){
+        _dropped++ ;
+      }
+      return false ;
+    }
+    _buf[ head & ( N - 1 ) ] = item ;
+    SPSC_BARRIER() ;
+    _head = head + 1 ;
+    return true ;
+  }
+
+  // Consumer side. Returns false when empty.
+  bool pop( T& item ){
+    uint8_t tail = _tail ;
+
+    if( tail == _head ){
+      return false ;
+    }
+    SPSC_BARRIER() ;
+    item = _buf[ tail & ( N - 1 ) ] ;
+    SPSC_BARRIER() ;
+    _tail = tail + 1 ;
+    return true ;
+  }
+
+  bool empty( void ) const {
+    return _head == _tail ;
+  }
+
+  bool full( void ) const {
+    return (uint8_t)( _head - _tail ) >= N ;
+  }
+
+  uint8_t size( void ) const {
+    return _head - _tail ;
+  }
+
+  // Items rejected by push() since the last call (saturates at 255).
+  uint8_t takeDropped( void ){
+    uint8_t d ;
+
+    ATOMIC_BLOCK( ATOMIC_RESTORESTATE ){
+      d = _dropped ;
+      _dropped = 0 ;
+    }
+    return d ;
+  }
+
+private:
+
+  T
+    _buf[ N ] ;
+
+  volatile uint8_t
+    _head ,
+    _tail ,
+    _dropped ;
+
+};
@@ -0,0 +1,163 @@
+/**************************************************************************/
+/*!
+    @file     stu_telemetry.cpp
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Compact binary telemetry: COBS framed, varint fields, message ids.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+    v0.0.2 - dt is relative to the last sent frame, so drops keep time.
+
+*/
+/**************************************************************************/
+
+#include "stu_telemetry.h"
+
+#ifdef TELEMETRY
+
+#include <util/crc16.h>
+
+StuTelemetry telemetry;
+
+
+StuTelemetry::StuTelemetry( void ):_len( 0 ), _dropped( 0 ), _last( 0 ), _stamp( 0 ), _lastPosition( 0 ){
+
+}
+
+void StuTelemetry::boot( uint32_t seed ){
+  _start( TLM_BOOT ) ;
+  _u( seed ) ;
+  _send() ;
+
+}
+
+void StuTelemetry::state( uint8_t state, uint8_t mode ){
+  _start( TLM_STATE ) ;
+  _u( state ) ;
+  _u( mode ) ;
+  _send() ;
+
+}
+
+// Rate limited; the loop moves far more often than the link can carry.
+void StuTelemetry::position( int x, int y ){
+  uint32_t now = millis() ;
+
+  if( now - _lastPosition < TLM_POSITION_INTERVAL ){
+    return ;
+  }
+  _lastPosition = now ;
+
+  _start( TLM_POSITION ) ;
+  _s( x ) ;
+  _s( y ) ;
+  _send() ;
+
+}
+
+void StuTelemetry::markov( uint8_t chain, uint8_t value ){
+  _start( TLM_MARKOV ) ;
+  _u( chain ) ;
+  _u( value ) ;
+  _send() ;
+
+}
+
+void StuTelemetry::pause( uint16_t ms, bool laser ){
+  _start( TLM_PAUSE ) ;
+  _u( ms ) ;
+  _u( laser ) ;
+  _send() ;
+
+}
+
+void StuTelemetry::nextPause( uint32_t ms ){
+  _start( TLM_NEXT_PAUSE ) ;
+  _u( ms ) ;
+  _send() ;
+
+}
+
+// _last only moves once the frame is written (_send()), so the dt of a
+// dropped frame carries into the next one and the decoder's clock holds.
+void StuTelemetry::_start( uint8_t id ){
+  _stamp = millis() ;
+
+  _len = 0 ;
+  _buf[ _len++ ] = id ;
+  _u( _stamp - _last ) ;
+
+}
+
+// Unsigned LEB128: 7 bits per byte, high bit set on all but the last.
+void StuTelemetry::_u( uint32_t v ){
+
+  while( v >= 0x80 && _len < TLM_MAX_FRAME - 1 ){
+    _buf[ _len++ ] = (uint8_t)v | 0x80 ;
+    v >>= 7 ;
+  }
+  if( _len < TLM_MAX_FRAME - 1 ){
+    _buf[ _len++ ] = (uint8_t)v ;
+  }
+
+}
+
+// Zig-zag: 0, -1, 1, -2 ... -> 0, 1, 2, 3 ... so small negatives stay short.
+void StuTelemetry::_s( int32_t v ){
+  _u( ( (uint32_t)v << 1 ) ^ (uint32_t)( v >> 31 ) ) ;
+
+}
+
+// COBS encode straight into the TX buffer. A frame of n bytes (crc
+// included) never needs more than n + 2 bytes on the wire (n < 254).
+void StuTelemetry::_send( void ){
+  uint8_t crc = 0 ;
+
+  for( uint8_t i = 0; i < _len; i++ ){
+    crc = _crc8_ccitt_update( crc, _buf[ i ] ) ;
+  }
+  _buf[ _len++ ] = crc ;
+
+  if( MY_SERIAL.availableForWrite() < _len + 2 ){
+    if( _dropped != 0xFF ){
+      _dropped++ ;
+    }
+    return ;
+  }
+
+  uint8_t out[ TLM_MAX_FRAME + 2 ] ;
+  uint8_t code = 1 ;
+  uint8_t codePos = 0 ;
+  uint8_t n = 1 ;
+
+  for( uint8_t i = 0; i < _len; i++ ){
+    if( _buf[ i ] == 0 ){
+      out[ codePos ] = code ;
+      codePos = n++ ;
+      code = 1 ;
+    }
+    else{
+      out[ n++ ] = _buf[ i ] ;
+      code++ ;
+    }
+  }
+  out[ codePos ] = code ;
+  out[ n++ ] = 0 ;
+
+  MY_SERIAL.write( out, n ) ;
+  _last = _stamp ;
+
+  if( _dropped ){
+    uint8_t d = _dropped ;
+    _dropped = 0 ;
+    _start( TLM_DROPPED ) ;
+    _u( d ) ;
+    _send() ;
+  }
+
+}
+
+#endif // TELEMETRY
@@ -0,0 +1,110 @@
+/**************************************************************************/
+/*!
+    @file     stu_telemetry.h
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Compact binary telemetry. Each event is one frame:
+
+      COBS( id | dt | field... | crc8 ) 0x00
+
+    id is a telemetry_e message id, dt the milliseconds since the previous
+    frame on the wire (dropped frames don't advance it) and every field an unsigned LEB128 varint (signed values are
+    zig-zag encoded first). crc8 is CRC-8/CCITT over the unencoded bytes.
+    COBS removes every zero from the frame so 0x00 always marks the end and
+    a decoder can resynchronise after any lost byte.
+
+    Frames are only written when they fit in the serial TX buffer, so
+    sending never blocks; frames that don't fit are counted and reported in
+    a TLM_DROPPED frame. Extra/Tools/telemetry_decode.py decodes the stream.
+
+    Enabled with TELEMETRY; otherwise the TLM_* macros compile to nothing.
+
+
+    @section  HISTORY
+    v0.0.1 - First release
+    v0.0.2 - dt is relative to the last sent frame, so drops keep time.
+
+*/
+/**************************************************************************/
+#pragma once
+
+#include "Arduino.h"
+#include "panTilt_config.h"
+
+#define TLM_MAX_FRAME          16 // unencoded bytes, id to crc
+#define TLM_POSITION_INTERVAL  50 // ms between position frames
+
+// Message ids (keep in sync with Extra/Tools/telemetry_decode.py)
+typedef enum {
+  TLM_BOOT       = 1 , // seed
+  TLM_STATE      = 2 , // state_e, runmode_e
+  TLM_POSITION   = 3 , // x, y (degrees)
+  TLM_MARKOV     = 4 , // chain (telemetryChain_e), value
+  TLM_PAUSE      = 5 , // duration ms, laser on
+  TLM_NEXT_PAUSE = 6 , // ms until the next pause
+  TLM_DROPPED    = 7   // frames dropped since the last report
+}telemetry_e;
+
+typedef enum {
+  TLM_CHAIN_SPEED = 0 ,
+  TLM_CHAIN_SHAKE     ,
+  TLM_CHAIN_PAUSE
+}telemetryChain_e;
+
+
+#ifdef TELEMETRY
+
+class StuTelemetry {
+
+public:
+
+  StuTelemetry( void ) ;
+
+  void
+    boot( uint32_t seed ) ,
+    state( uint8_t state, uint8_t mode ) ,
+    position( int x, int y ) ,
+    markov( uint8_t chain, uint8_t value ) ,
+    pause( uint16_t ms, bool laser ) ,
+    nextPause( uint32_t ms ) ;
+
+private:
+
+  void
+    _start( uint8_t id ) ,
+    _u( uint32_t v ) ,
+    _s( int32_t v ) ,
+    _send( void ) ;
+
+  uint8_t
+    _buf[ TLM_MAX_FRAME ] ,
+    _len ,
+    _dropped ;
+
+  uint32_t
+    _last ,               // time of the last frame actually sent
+    _stamp ,              // time of the frame being built
+    _lastPosition ;
+
+};
+
+extern StuTelemetry telemetry;
+
+  #define TLM_BOOT( s )                 telemetry.boot( s )
+  #define TLM_STATE( st, m )            telemetry.state( st, m )
+  #define TLM_POSITION( x, y )          telemetry.position( x, y )
+  #define TLM_MARKOV( c, v )            telemetry.markov( c, v )
+  #define TLM_PAUSE( ms, l )            telemetry.pause( ms, l )
+  #define TLM_NEXT_PAUSE( ms )          telemetry.nextPause( ms )
+
+#else
+
+  #define TLM_BOOT( s )
+  #define TLM_STATE( st, m )
+  #define TLM_POSITION( x, y )
+  #define TLM_MARKOV( c, v )
+  #define TLM_PAUSE( ms, l )
+  #define TLM_NEXT_PAUSE( ms )
+
+#endif
@@ -0,0 +1,103 @@
+/**************************************************************************/
+/*!
+    @file     stu_walk.h
+    @author   Stuart Feichtinger
+    @license  MIT (see license.txt)
+
+    Markov random walk for the pan-tilt axes. Templated on the axis type
+    so the midpoint, limit and probability offset math constant-folds;
+    walkAxes() steps that axis of every turret in one pass over the axis
+    bank (stuPanTilt.h).
+
+    The direction-flip probability only depends on the distance from the
+    midpoint and whether the axis is moving outward, so it is baked into an
+    8-bit threshold table per axis at boot (buildDirectionTable()). A step
+    is then one table lookup and one byte compare.
+
+
+    @section  HISTORY
+    v0.0.1 - First release (moved out of Pan_Tilt_laser.ino)
+    v0.1.0 - Precomputed per-angle direction-flip threshold tables.
+    v0.1.1 - Soft limits for live tuning.
+    v0.2.0 - Works on the structure-of-arrays axis bank, all turrets per call.
+
+*/
+/**************************************************************************/
+#pragma once
+
+#include "Arduino.h"
+#include "stuPanTilt.h"
+#include "stu_random.h"
+
+
+template< class AXIS >
+struct directionTable_t {
+
+  // Largest distance from the midpoint inside the limits
+  static const int
+    maxDistance = ( AXIS::midAngle - AXIS::minAngle ) > ( AXIS::maxAngle - AXIS::midAngle ) ?
+                  ( AXIS::midAngle - AXIS::minAngle ) : ( AXIS::maxAngle - AXIS::midAngle ) ;
+
+  // Flip threshold (out of 256) by distance from the midpoint. Entry 0 is
+  // also used whenever the axis is heading back towards the midpoint.
+  static uint8_t
+    threshold[ maxDistance + 1 ] ;
+
+};
+
+template< class AXIS > const int directionTable_t< AXIS >::maxDistance;
+template< class AXIS > uint8_t directionTable_t< AXIS >::threshold[ directionTable_t< AXIS >::maxDistance + 1 ];
+
+
+// Fill the axis table. Same odds as the old per-step test
+// random(1001) <= 2 * ( changeProb + distance * probOffset ), rescaled to a
+// byte. Reshape the center bias here.
+template< class AXIS >
+void buildDirectionTable( int changeProb ){
+  typedef directionTable_t< AXIS > table;
+
+  for( int d = 0; d <= table::maxDistance; d++ ){
+    long prob = changeProb + (long)d * max(AXIS::probOffset, 1);
+    long t = ( ( 2 * prob + 1 ) * 256 + 500 ) / 1001;
+    table::threshold[ d ] = t > 255 ? 255 : t;
+  }
+}
+
+
+// lo/hi are soft limits inside the axis limits (live-tunable, stu_params.h).
+template< class AXIS >
+int8_t getMarkovDirection( int angle, int8_t& dir, int lo = AXIS::minAngle, int hi = AXIS::maxAngle ){
+  typedef directionTable_t< AXIS > table;
+
+  uint8_t t = table::threshold[ 0 ];
+
+  if(dir == 0){
+    dir = 1;
+  }
+
+  if(dir == 1 && angle >= AXIS::midAngle){
+    int d = angle - AXIS::midAngle;
+    t = table::threshold[ min(d, table::maxDistance) ];
+  }
+  else if(dir == -1 && angle <= AXIS::midAngle){
+    int d = AXIS::midAngle - angle;
+    t = table::threshold[ min(d, table::maxDistance) ];
+  }
+
+  if(rng.nextByte() < t || (angle >= hi && dir == 1) || (angle <= lo && dir == -1)){
+    dir = -dir;
+  }
+  return dir;
+}
+
+
+// One step for n turrets: angle[i] moves speed[i] degrees in its walk
+// direction. Arrays are the axis bank fields for this axis.
+template< class AXIS >
+void walkAxes( int16_t* angle, int8_t* dir, const uint8_t* speed, uint8_t n, int lo = AXIS::minAngle, int hi = AXIS::maxAngle ){
+
+  for( uint8_t i = 0; i < n; i++ ){
+    angle[ i ] += getMarkovDirection< AXIS >( angle[ i ], dir[ i ], lo, hi ) * speed[ i ];
+  }
+
+}